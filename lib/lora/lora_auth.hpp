@@ -0,0 +1,124 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <lora_crypto.hpp>
+
+/*
+ * Truncated AES-CMAC (RFC 4493) frame tags.
+ *
+ * The tag covers the header (minus the hop count relays rewrite), the payload as sent (ciphertext when
+ * encrypted) and the epoch, and is appended after the epoch:
+ *   PAYLOAD | EPOCH(4) | TAG(HC15_MAC_TAG_LEN)
+ * Block encryptions go through HC15Cipher, i.e. the AES peripheral on target. (epoch, seq) is the
+ * frame counter the receiver's replay window checks, so the epoch must grow across reboots when
+ * authentication is on (see HC15BootEpoch).
+ */
+
+#ifndef HC15_MAC_TAG_LEN
+#define HC15_MAC_TAG_LEN 4 // 截断的 CMAC 字节数，4~8，全网一致
+#endif
+
+static_assert(HC15_MAC_TAG_LEN >= 4 && HC15_MAC_TAG_LEN <= 8, "HC15_MAC_TAG_LEN must be 4..8");
+
+class HC15Cmac
+{
+public:
+    /*
+     * @brief Load the MAC key (use a different key than the payload cipher) and derive the subkeys.
+     */
+    bool setKey(const uint8_t *key, uint16_t bits)
+    {
+        uint8_t zero[16] = {0};
+        uint8_t l[16];
+        if (!aes_.setKey(key, bits) || !aes_.block(zero, l))
+            return false;
+        shift(l, k1_);
+        shift(k1_, k2_);
+        return true;
+    }
+
+    bool ready() const { return aes_.ready(); }
+
+    /*
+     * @brief Full 16-byte CMAC of two concatenated buffers (header and body, no staging copy).
+     */
+    bool compute(const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len, uint8_t mac[16])
+    {
+        uint8_t x[16] = {0};
+        uint8_t m[16];
+        size_t total = a_len + b_len;
+        size_t fill = 0;
+        for (size_t i = 0; i < total; i++)
+        {
+            if (fill == 16)
+            {
+                // 只有确定后面还有数据时才加密当前块，最后一块要混入子密钥
+                for (uint8_t j = 0; j < 16; j++)
+                    x[j] ^= m[j];
+                if (!aes_.block(x, x))
+                    return false;
+                fill = 0;
+            }
+            m[fill++] = i < a_len ? a[i] : b[i - a_len];
+        }
+
+        const uint8_t *k = k1_;
+        if (fill < 16)
+        {
+            m[fill++] = 0x80;
+            while (fill < 16)
+                m[fill++] = 0;
+            k = k2_; // 不满一块（含空消息）补位后用 K2
+        }
+        for (uint8_t j = 0; j < 16; j++)
+            x[j] ^= m[j] ^ k[j];
+        return aes_.block(x, mac);
+    }
+
+    /*
+     * @brief Compare n tag bytes without data-dependent timing.
+     */
+    static bool equal(const uint8_t *a, const uint8_t *b, size_t n)
+    {
+        uint8_t d = 0;
+        for (size_t i = 0; i < n; i++)
+            d |= a[i] ^ b[i];
+        return d == 0;
+    }
+
+private:
+    static void shift(const uint8_t in[16], uint8_t out[16])
+    {
+        uint8_t carry = in[0] >> 7;
+        for (uint8_t i = 0; i < 15; i++)
+            out[i] = static_cast<uint8_t>((in[i] << 1) | (in[i + 1] >> 7));
+        out[15] = static_cast<uint8_t>((in[15] << 1) ^ (carry ? 0x87 : 0));
+    }
+
+    HC15Cipher aes_;
+    uint8_t k1_[16];
+    uint8_t k2_[16];
+};
+
+#ifdef ARDUINO
+#include <Preferences.h>
+
+class HC15BootEpoch
+{
+public:
+    /*
+     * @brief Monotonic epoch for this boot: a boot counter kept in NVS, shifted left by 8 so the
+     *        link can bump it on up to 255 seq wraps before the next boot's range starts.
+     */
+    static uint32_t next()
+    {
+        Preferences prefs;
+        prefs.begin("hc15", false);
+        uint32_t boots = prefs.getUInt("boots", 0) + 1;
+        prefs.putUInt("boots", boots);
+        prefs.end();
+        return boots << 8;
+    }
+};
+#endif
@@ -0,0 +1,145 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Fixed-size chunk bitmap, byte oriented (bit i lives in byte i / 8, LSB first) so ranges of it
+ * can be copied into NACK / status frames and persisted as is.
+ */
+template <uint16_t BITS>
+class HC15Bitmap
+{
+public:
+    static const uint16_t BYTES = (BITS + 7) / 8;
+
+    HC15Bitmap()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        memset(bits_, 0, sizeof(bits_));
+    }
+
+    /*
+     * @brief Set bits [0, n).
+     */
+    void fill(uint16_t n)
+    {
+        clear();
+        if (n > BITS)
+            n = BITS;
+        memset(bits_, 0xFF, n / 8);
+        if (n % 8)
+            bits_[n / 8] = static_cast<uint8_t>((1u << (n % 8)) - 1);
+    }
+
+    void set(uint16_t i)
+    {
+        if (i < BITS)
+            bits_[i >> 3] |= static_cast<uint8_t>(1u << (i & 7));
+    }
+
+    void reset(uint16_t i)
+    {
+        if (i < BITS)
+            bits_[i >> 3] &= static_cast<uint8_t>(~(1u << (i & 7)));
+    }
+
+    bool test(uint16_t i) const
+    {
+        return i < BITS && (bits_[i >> 3] >> (i & 7)) & 1;
+    }
+
+    /*
+     * @brief Number of set bits in [0, n).
+     */
+    uint16_t count(uint16_t n = BITS) const
+    {
+        uint16_t c = 0;
+        for (uint16_t i = 0; i < n && i < BITS; i++)
+            c += test(i);
+        return c;
+    }
+
+    /*
+     * @brief First clear bit in [from, n), whole full bytes are skipped at once.
+     * @return The bit index, or -1 if all are set.
+     */
+    int firstClear(uint16_t n, uint16_t from = 0) const
+    {
+        for (uint16_t i = from; i < n && i < BITS;)
+        {
+            if ((i & 7) == 0 && bits_[i >> 3] == 0xFF)
+            {
+                i += 8;
+                continue;
+            }
+            if (!test(i))
+                return i;
+            i++;
+        }
+        return -1;
+    }
+
+    /*
+     * @brief First set bit in [from, n), whole empty bytes are skipped at once.
+     * @return The bit index, or -1 if none is set.
+     */
+    int firstSet(uint16_t n, uint16_t from = 0) const
+    {
+        for (uint16_t i = from; i < n && i < BITS;)
+        {
+            if ((i & 7) == 0 && bits_[i >> 3] == 0)
+            {
+                i += 8;
+                continue;
+            }
+            if (test(i))
+                return i;
+            i++;
+        }
+        return -1;
+    }
+
+    bool any() const
+    {
+        for (uint16_t i = 0; i < BYTES; i++)
+        {
+            if (bits_[i])
+                return true;
+        }
+        return false;
+    }
+
+    /*
+     * @brief OR len raw bytes into the bitmap starting at byte offset.
+     */
+    void merge(uint16_t byte_offset, const uint8_t *src, uint16_t len)
+    {
+        for (uint16_t i = 0; i < len && byte_offset + i < BYTES; i++)
+            bits_[byte_offset + i] |= src[i];
+    }
+
+    /*
+     * @brief Replace everything from byte offset on with len raw bytes, bytes past them are cleared.
+     *        Bytes before offset are set (a status snapshot starts at the first incomplete byte).
+     */
+    void assign(uint16_t byte_offset, const uint8_t *src, uint16_t len)
+    {
+        for (uint16_t i = 0; i < BYTES; i++)
+        {
+            if (i < byte_offset)
+                bits_[i] = 0xFF;
+            else
+                bits_[i] = i - byte_offset < len ? src[i - byte_offset] : 0;
+        }
+    }
+
+    uint8_t *bytes() { return bits_; }
+    const uint8_t *bytes() const { return bits_; }
+
+private:
+    uint8_t bits_[BYTES];
+};
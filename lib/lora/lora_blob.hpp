@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * @brief Pull len bytes of a blob / file at offset into out (transfer services).
+ * @return The number of bytes read.
+ */
+typedef size_t (*HC15BlobReader)(uint32_t offset, uint8_t *out, size_t len, void *ctx);
+
+/*
+ * @brief Store len received bytes of a blob / file at offset (transfer services).
+ * @return false to report a storage error (the chunk is then requested again).
+ */
+typedef bool (*HC15BlobWriter)(uint32_t offset, const uint8_t *data, size_t len, void *ctx);
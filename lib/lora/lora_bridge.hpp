@@ -0,0 +1,259 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/stream_buffer.h>
+#include <freertos/message_buffer.h>
+#include <lora_class.hpp>
+#include <lora_frame.hpp>
+
+/*
+ * Transparent LoRa <-> USB bridge for gateways.
+ *
+ * Radio bytes go from the HC15 RX callback straight into a FreeRTOS stream buffer (one copy), the
+ * uplink task pulls them out in blocks of up to HC15_BRIDGE_USB_CHUNK and hands each block to the
+ * USB CDC / USB-Serial-JTAG port in a single write. It waits up to HC15_BRIDGE_FLUSH_MS for more
+ * bytes first, so a burst of frames becomes one USB transfer instead of one println per line.
+ * Host bytes are read in blocks the same way. In RAW mode they go to the radio in packets of up to
+ * HC15_BRIDGE_AIR_CHUNK as they come; in FRAMES mode the host stream is split at air frame boundaries
+ * (lora_frame.hpp wire format, plain or FEC) so every HC-15 packet carries exactly one whole frame,
+ * and bytes between frames are dropped.
+ */
+
+#ifndef HC15_BRIDGE_RING
+#define HC15_BRIDGE_RING 4096 // 每个方向的环形缓冲
+#endif
+
+#ifndef HC15_BRIDGE_USB_CHUNK
+#define HC15_BRIDGE_USB_CHUNK 512 // 单次 USB 写入上限
+#endif
+
+#ifndef HC15_BRIDGE_AIR_CHUNK
+#define HC15_BRIDGE_AIR_CHUNK 120 // 单次发往模块的字节数，不超过 HC-15 一包
+#endif
+
+#ifndef HC15_BRIDGE_FLUSH_MS
+#define HC15_BRIDGE_FLUSH_MS 5 // 凑批等待时间，决定额外延迟
+#endif
+
+enum class HC15_BRIDGE_DOWNLINK
+{
+    RAW = 0,    // 主机字节原样分包发出
+    FRAMES = 1, // 按空中帧切分，一包一帧
+};
+
+class HC15UsbBridge
+{
+public:
+    HC15UsbBridge(HC15 *hc15, Stream *usb) : hc15_(hc15), usb_(usb) {}
+
+    /*
+     * @brief Create the rings and take over the HC15 receive path (readLine() is no longer fed).
+     */
+    bool begin(HC15_BRIDGE_DOWNLINK mode = HC15_BRIDGE_DOWNLINK::RAW)
+    {
+        if (!hc15_ || !usb_)
+            return false;
+        mode_ = mode;
+        // 触发水位 = 一个 USB 块，未满时靠 FLUSH_MS 超时收尾
+        up_ = xStreamBufferCreate(HC15_BRIDGE_RING, HC15_BRIDGE_USB_CHUNK);
+        if (mode_ == HC15_BRIDGE_DOWNLINK::FRAMES)
+            down_ = xMessageBufferCreate(HC15_BRIDGE_RING); // 消息边界即帧边界
+        else
+            down_ = xStreamBufferCreate(HC15_BRIDGE_RING, HC15_BRIDGE_AIR_CHUNK);
+        if (!up_ || !down_)
+            return false;
+        hc15_->setRxCallback(&HC15UsbBridge::onRadio, this);
+        return true;
+    }
+
+    /*
+     * @brief Radio -> USB, use rtos task please.
+     */
+    void uplinkTask(void * /*pvParameters*/)
+    {
+        for (;;)
+        {
+            // 先等到第一个字节，再给一个短窗口攒批
+            size_t n = xStreamBufferReceive(up_, usb_buf_, 1, portMAX_DELAY);
+            if (n == 0)
+                continue;
+            n += xStreamBufferReceive(up_, usb_buf_ + n, sizeof(usb_buf_) - n, pdMS_TO_TICKS(HC15_BRIDGE_FLUSH_MS));
+            size_t done = 0;
+            while (done < n)
+            {
+                size_t w = usb_->write(usb_buf_ + done, n - done);
+                if (w == 0)
+                {
+                    usb_dropped_ += n - done; // 主机没在读，丢掉而不是卡住收音
+                    break;
+                }
+                done += w;
+            }
+            uplink_bytes_ += done;
+            usb_writes_++;
+        }
+    }
+
+    /*
+     * @brief USB -> ring, use rtos task please.
+     */
+    void hostTask(void * /*pvParameters*/)
+    {
+        uint8_t buf[HC15_BRIDGE_USB_CHUNK];
+        for (;;)
+        {
+            int avail = usb_->available();
+            if (avail <= 0)
+            {
+                vTaskDelay(1);
+                continue;
+            }
+            size_t room = xStreamBufferSpacesAvailable(down_);
+            if (room == 0)
+            {
+                vTaskDelay(1); // 电台跟不上时让 USB 端反压
+                continue;
+            }
+            size_t want = static_cast<size_t>(avail);
+            if (want > sizeof(buf))
+                want = sizeof(buf);
+            if (want > room)
+                want = room;
+            size_t n = usb_->readBytes(buf, want);
+            if (mode_ == HC15_BRIDGE_DOWNLINK::FRAMES)
+            {
+                for (size_t i = 0; i < n; i++)
+                    splitFrame(buf[i]);
+            }
+            else
+            {
+                xStreamBufferSend(down_, buf, n, 0);
+            }
+        }
+    }
+
+    /*
+     * @brief Ring -> radio, use rtos task please.
+     */
+    void downlinkTask(void * /*pvParameters*/)
+    {
+        uint8_t buf[HC15_BRIDGE_AIR_CHUNK > HC15_FRAME_MAX_WIRE ? HC15_BRIDGE_AIR_CHUNK : HC15_FRAME_MAX_WIRE];
+        for (;;)
+        {
+            size_t n;
+            if (mode_ == HC15_BRIDGE_DOWNLINK::FRAMES)
+            {
+                n = xMessageBufferReceive(down_, buf, sizeof(buf), portMAX_DELAY); // 整帧，和 HC15Link::sendFrame 一样一次发出
+            }
+            else
+            {
+                n = xStreamBufferReceive(down_, buf, 1, portMAX_DELAY);
+                if (n)
+                    n += xStreamBufferReceive(down_, buf + n, HC15_BRIDGE_AIR_CHUNK - n, pdMS_TO_TICKS(HC15_BRIDGE_FLUSH_MS));
+            }
+            if (n == 0)
+                continue;
+            if (hc15_->send(buf, n) == static_cast<int>(n))
+                downlink_bytes_ += n;
+            else
+                air_dropped_ += n;
+        }
+    }
+
+    uint32_t uplinkBytes() const { return uplink_bytes_; }
+    uint32_t downlinkBytes() const { return downlink_bytes_; }
+    uint32_t usbWrites() const { return usb_writes_; }
+    uint32_t ringDropped() const { return ring_dropped_; }
+    uint32_t usbDropped() const { return usb_dropped_; }
+    uint32_t airDropped() const { return air_dropped_; }
+    uint32_t hostFrames() const { return host_frames_; }
+    uint32_t hostDiscarded() const { return host_discarded_; } // FRAMES 模式下帧外 / 非法长度的主机字节
+
+private:
+    static void onRadio(const uint8_t *data, size_t len, void *ctx)
+    {
+        HC15UsbBridge *self = static_cast<HC15UsbBridge *>(ctx);
+        size_t n = xStreamBufferSend(self->up_, data, len, 0); // monitorTask 里不能阻塞
+        self->ring_dropped_ += len - n;
+    }
+
+    /*
+     * @brief FRAMES mode: find air frame boundaries in the host stream by SYNC and LEN only, the radio
+     *        side checks the CRC. A finished frame is queued whole, blocking the host task while the
+     *        ring is full so the USB side sees backpressure.
+     */
+    void splitFrame(uint8_t c)
+    {
+        if (split_pos_ == 0)
+        {
+            if (c != HC15_FRAME_SYNC && c != HC15_FRAME_SYNC_FEC)
+            {
+                host_discarded_++;
+                return;
+            }
+            split_buf_[split_pos_++] = c;
+            split_len_ = 0;
+            return;
+        }
+        split_buf_[split_pos_++] = c;
+        bool fec = split_buf_[0] == HC15_FRAME_SYNC_FEC;
+        if (split_len_ == 0)
+        {
+            uint8_t len;
+            if (!fec)
+            {
+                len = c; // SYNC LEN
+                split_len_ = len + 4u; // SYNC + LEN + body + CRC16
+            }
+            else if (split_pos_ == 2)
+            {
+                if (!HC15FrameCodec::fecParityFromCode(c))
+                    return discardSplit();
+                return;
+            }
+            else if (split_pos_ < HC15_FRAME_FEC_HEADER_LEN)
+            {
+                return;
+            }
+            else
+            {
+                // 三取二，和 HC15FrameParser 一样
+                const uint8_t *l = split_buf_ + 2;
+                len = (l[0] & l[1]) | (l[0] & l[2]) | (l[1] & l[2]);
+                // SYNC_FEC + MODE + LEN x3 + LEN + body + CRC16 + parity
+                split_len_ = HC15_FRAME_FEC_HEADER_LEN + len + 3u + HC15FrameCodec::fecParityFromCode(split_buf_[1]);
+            }
+            if (len < HC15_FRAME_HEADER_LEN || len > HC15_FRAME_HEADER_LEN + HC15_FRAME_MAX_BODY)
+                return discardSplit();
+            return;
+        }
+        if (split_pos_ < split_len_)
+            return;
+        xMessageBufferSend(down_, split_buf_, split_pos_, portMAX_DELAY);
+        host_frames_++;
+        split_pos_ = 0;
+    }
+
+    void discardSplit()
+    {
+        host_discarded_ += split_pos_;
+        split_pos_ = 0;
+    }
+
+    HC15 *hc15_ = nullptr;
+    Stream *usb_ = nullptr;
+    HC15_BRIDGE_DOWNLINK mode_ = HC15_BRIDGE_DOWNLINK::RAW;
+    StreamBufferHandle_t up_ = nullptr;
+    StreamBufferHandle_t down_ = nullptr;
+    uint8_t usb_buf_[HC15_BRIDGE_USB_CHUNK];
+    uint32_t uplink_bytes_ = 0;
+    uint32_t downlink_bytes_ = 0;
+    uint32_t usb_writes_ = 0;
+    uint32_t ring_dropped_ = 0;
+    uint32_t usb_dropped_ = 0;
+    uint32_t air_dropped_ = 0;
+    uint8_t split_buf_[HC15_FRAME_MAX_WIRE];
+    size_t split_pos_ = 0;
+    size_t split_len_ = 0;
+    uint32_t host_frames_ = 0;
+    uint32_t host_discarded_ = 0;
+};
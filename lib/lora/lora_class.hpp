@@ -1,5 +1,35 @@
 #pragma once
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <lora_gpio.hpp>
+
+#ifndef HC15_RX_STAMPS
+#define HC15_RX_STAMPS 8 // readBuffer 中可追溯时间戳的接收批次数
+#endif
+
+#ifndef HC15_BURST_MAX
+#define HC15_BURST_MAX 256 // 突发模式单帧上限，更长的突发拆成多次回调
+#endif
+
+#ifndef HC15_LOG
+#ifdef HC15_BRIDGE_MODE
+#define HC15_LOG(msg) ((void)0) // 桥接模式下 Serial 是主机数据口，不能混入文本
+#else
+#define HC15_LOG(msg) Serial.println(msg)
+#endif
+#endif
+
+#ifndef HC15_BURST_IDLE_CHARS
+#define HC15_BURST_IDLE_CHARS 3 // 线路空闲多少个字符时间算帧结束
+#endif
+
+#ifndef HC15_AIR_BPS_TABLE
+#define HC15_AIR_BPS_TABLE {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200} // AT+S1~S8 的空中速率，固件不同可覆盖
+#endif
+
+#ifndef HC15_AIR_GAP_BYTES
+#define HC15_AIR_GAP_BYTES 16 // 相邻空中包之间的空闲（前导码、包头、收发切换），按空速折算的字节数
+#endif
 
 enum class HC15_ERROR_TYPE
 {
@@ -8,19 +38,61 @@ enum class HC15_ERROR_TYPE
     TIMEOUT_ERROR = 2,
 };
 
+/*
+ * @brief UART receive tuning, see HC15::setUartProfile().
+ */
+enum class HC15_UART_PROFILE
+{
+    LOW_LATENCY = 0, // 小阈值、短超时：每个短帧尽快交出去
+    BALANCED = 1,    // 默认
+    BULK = 2,        // 大阈值、大缓冲：连续大流量时中断最少
+};
+
+struct HC15UartSettings
+{
+    uint8_t rx_fifo_full; // 触发搬运的 FIFO 字节数（C3 FIFO 128 字节）
+    uint8_t rx_timeout;   // 线路空闲多少个字符时间触发搬运
+    size_t rx_buffer;     // 驱动环形缓冲大小
+};
+
+/*
+ * @brief Raw receive hook, called from monitorTask with the semaphore already released.
+ */
+typedef void (*HC15RxCallback)(const uint8_t *data, size_t len, void *ctx);
+
+/*
+ * @brief esp_timer capture time of the first and last byte of a received line / frame, in us.
+ *        Taken in the UART RX event (FIFO full / RX timeout), so it does not depend on how often
+ *        monitorTask polls; bytes inside a burst are placed one character time apart.
+ */
+struct HC15RxStamp
+{
+    int64_t first_us = 0;
+    int64_t last_us = 0;
+};
+
 class HC15
 {
 public:
     HC15(HardwareSerial *serial, uint32_t baud_rate, uint8_t rx_pin, uint8_t tx_pin, uint16_t timeout, uint8_t sta_pin, uint8_t key_pin) : serial_(serial), baud_rate_(baud_rate), rx_pin_(rx_pin), tx_pin_(tx_pin), timeout_(timeout), sta_pin_(sta_pin), key_pin_(key_pin)
     {
         hc15_buzy_semaphore_ = xSemaphoreCreateBinary();
+        sta_ = HC15FastPin(sta_pin_); // 掩码只算一次
+        key_ = HC15FastPin(key_pin_);
     }
 
     bool begin()
     {
         if (serial_)
         {
+            HC15UartSettings uart = uartSettings(uart_profile_, baud_rate_, air_bps_);
+            serial_->end(); // 驱动已装好时 setRxBufferSize 会被拒绝，先卸掉
+            if (serial_->setRxBufferSize(uart.rx_buffer) != uart.rx_buffer)
+                HC15_LOG("HC15 RX buffer size not applied: " + String(uart.rx_buffer));
             serial_->begin(baud_rate_, SERIAL_8N1, rx_pin_, tx_pin_);
+            serial_->setRxFIFOFull(uart.rx_fifo_full);
+            serial_->setRxTimeout(uart.rx_timeout);
+            serial_->onReceive([this]() { onUartEvent(); }, false); // 只打时间戳，读数据仍在 monitorTask
         }
         else
         {
@@ -29,15 +101,98 @@ public:
 
         pinMode(sta_pin_, INPUT_PULLDOWN);
         pinMode(key_pin_, OUTPUT);
-        digitalWrite(key_pin_, HIGH); // Set key pin to HIGH to ensure HC-15 is in command mode
+        key_.high(); // Set key pin to HIGH to ensure HC-15 is in command mode
 
-        Serial.println("STA_PIN:" + String(sta_pin_) + ", KEY_PIN:" + String(key_pin_));
+        HC15_LOG("STA_PIN:" + String(sta_pin_) + ", KEY_PIN:" + String(key_pin_));
 
         serial_->flush();                     // clear the serial
+        began_ = true;
         xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore to indicate that the HC-15 is ready
         return true;
     }
 
+    /*
+     * @brief Pick the UART receive tuning applied by begin().
+     * @param air_bps Overrides the air data rate, 0 keeps the one recorded by setSpeed() (or the UART
+     *        rate if setSpeed() was never called). Slower air means the module delivers less per
+     *        second and leaves longer gaps between packets, see uartSettings().
+     * @note After begin() only the FIFO threshold and timeout change, the buffer size needs a new begin().
+     *       While burst mode is on they are left alone and applied when it is switched off.
+     */
+    void setUartProfile(HC15_UART_PROFILE profile, uint32_t air_bps = 0)
+    {
+        uart_profile_ = profile;
+        if (air_bps)
+            air_bps_ = air_bps;
+        applyRxTuning();
+    }
+
+    /*
+     * @brief Air data rate of an AT+S speed level, 0 if the level is out of range.
+     */
+    static uint32_t airBps(uint8_t speed)
+    {
+        static const uint32_t table[8] = HC15_AIR_BPS_TABLE;
+        return speed >= 1 && speed <= 8 ? table[speed - 1] : 0;
+    }
+
+    /*
+     * @brief The settings a profile resolves to for a given UART baud and air rate.
+     *        FIFO threshold: what arrives within the profile's latency budget at the inbound byte rate.
+     *        RX timeout: a share of the gap between air packets, in UART character times, capped by the
+     *        budget, so a packet ends in one timeout without waiting out the whole gap.
+     * @param air_bps The air data rate, 0 if unknown (taken as the UART rate).
+     */
+    static HC15UartSettings uartSettings(HC15_UART_PROFILE profile, uint32_t baud, uint32_t air_bps)
+    {
+        HC15UartSettings s;
+        uint32_t budget_us; // 一次搬运允许攒的延迟
+        uint32_t gap_pct;   // RX 超时占包间隔的比例
+        uint32_t drain_ms;  // 接收缓冲要扛住的消费者停顿时间
+        switch (profile)
+        {
+        case HC15_UART_PROFILE::LOW_LATENCY:
+            budget_us = 2000;
+            gap_pct = 25;
+            drain_ms = 50;
+            break;
+        case HC15_UART_PROFILE::BULK:
+            budget_us = 50000;
+            gap_pct = 75;
+            drain_ms = 500;
+            break;
+        default:
+            budget_us = 10000;
+            gap_pct = 50;
+            drain_ms = 200;
+            break;
+        }
+        uint32_t char_rate = baud / 10 ? baud / 10 : 1; // 串口每秒字符数
+        if (!air_bps)
+            air_bps = baud;
+        // 实际进入串口的速率受空速限制
+        uint32_t rate = char_rate;
+        if (air_bps / 8 < rate)
+            rate = air_bps / 8;
+
+        uint64_t fifo = static_cast<uint64_t>(rate) * budget_us / 1000000;
+        s.rx_fifo_full = static_cast<uint8_t>(fifo < 1 ? 1 : fifo > 120 ? 120 : fifo); // C3 FIFO 128 字节
+
+        uint64_t gap_chars = static_cast<uint64_t>(HC15_AIR_GAP_BYTES) * 8 * char_rate / air_bps;
+        uint64_t tout = gap_chars * gap_pct / 100;
+        uint64_t budget_chars = static_cast<uint64_t>(char_rate) * budget_us / 1000000;
+        if (tout > budget_chars)
+            tout = budget_chars;
+        s.rx_timeout = static_cast<uint8_t>(tout < 1 ? 1 : tout > 100 ? 100 : tout); // 硬件上限约 101 个字符
+
+        size_t need = static_cast<size_t>(rate) * drain_ms / 1000;
+        size_t buf = 256; // Arduino 要求大于 FIFO 128
+        while (buf < need && buf < 16384)
+            buf <<= 1;
+        s.rx_buffer = buf;
+        return s;
+    }
+
     /*
      * @brief Check for errors in the HC-15 module.
      * @return The error type if an error is detected, or NONE if no error is found.
@@ -46,7 +201,7 @@ public:
     {
         if (!serial_)
         {
-            Serial.println("HC-15 serial port is not initialized.");
+            HC15_LOG("HC-15 serial port is not initialized.");
             return HC15_ERROR_TYPE::SERIAL_ERROR;
         }
         return HC15_ERROR_TYPE::NONE;
@@ -74,7 +229,7 @@ public:
 
         if (errorCheck() != HC15_ERROR_TYPE::NONE)
         {
-            Serial.println("HC-15 error detected, task will not start.");
+            HC15_LOG("HC-15 error detected, task will not start.");
             vTaskDelete(nullptr);
         }
 
@@ -84,21 +239,123 @@ public:
             if (xSemaphoreTake(hc15_buzy_semaphore_, pdMS_TO_TICKS(5000)) == pdTRUE)
             {
                 // 2.2 只有模块空闲 & 串口有数据才读
-                if (!isBuzy() && serial_->available() > 0)
+                size_t got = 0;
+                if (!burst_cb_ && !isBuzy() && serial_->available() > 0) // 突发模式由 UART 事件读取
                 {
-                    // 读到本地缓冲，减少锁占用时间
-                    String chunk = serial_->readString();
-                    readBuffer.reserve(readBuffer.length() + chunk.length());
-                    readBuffer += chunk;
+                    if (rx_cb_)
+                    {
+                        // 二进制模式：只搬运字节，解析放到锁外
+                        got = serial_->read(rx_chunk_, sizeof(rx_chunk_));
+                        rx_chunk_stamp_ = takeRxStamp(got);
+                        rx_chunk_len_ = got;
+                    }
+                    else
+                    {
+                        // 读到本地缓冲，减少锁占用时间
+                        String chunk = serial_->readString();
+                        appendRx(chunk, takeRxStamp(chunk.length()));
+                    }
                 }
                 xSemaphoreGive(hc15_buzy_semaphore_); // 2.3 立刻放锁
+
+                if (got > 0)
+                {
+                    rx_cb_(rx_chunk_, got, rx_ctx_);
+                    if (got == sizeof(rx_chunk_))
+                        continue; // 还有剩余字节，不休眠直接再读
+                }
             }
 
             vTaskDelay(pdMS_TO_TICKS(delay_ms));
         }
     }
 
+    /*
+     * @brief Burst mode: every air packet, which the HC-15 writes to the UART as one contiguous burst,
+     *        is delivered as one frame. The boundary is the hardware RX timeout (line idle for
+     *        idle_chars character times), so there is no delimiter in the data and nothing to scan.
+     *        Runs in the UART event task; monitorTask stops reading while it is on.
+     * @param cb The frame callback, nullptr switches back to monitorTask reading.
+     * @param idle_chars The gap that ends a frame, must be shorter than the gap between air packets.
+     * @note Call after begin().
+     */
+    void setBurstCallback(HC15RxCallback cb, void *ctx = nullptr, uint8_t idle_chars = HC15_BURST_IDLE_CHARS)
+    {
+        if (!serial_)
+            return;
+        burst_ctx_ = ctx;
+        burst_cb_ = cb;
+        burst_idle_chars_ = idle_chars ? idle_chars : 1;
+        if (cb)
+        {
+            serial_->setRxTimeout(burst_idle_chars_);
+            serial_->onReceive([this]() { onBurstEnd(); }, true); // 只在 RX 超时时回调
+        }
+        else
+        {
+            serial_->onReceive([this]() { onUartEvent(); }, false);
+            applyRxTuning(); // 打开时 onReceive(.., true) 把阈值改成了 120，超时改成了空闲间隔
+        }
+    }
+
+    uint32_t burstFrames() const { return burst_frames_; }
+    uint32_t burstSplits() const { return burst_splits_; }
+
+    /*
+     * @brief Capture time of byte i of the chunk being passed to the RX / burst callback, only valid inside it.
+     */
+    int64_t rxByteTime(size_t i) const
+    {
+        return byteTime(rx_chunk_stamp_, rx_chunk_len_ - 1 - i);
+    }
+
+    /*
+     * @brief Route received bytes to a callback instead of readBuffer (binary / frame mode).
+     * @param cb The callback, nullptr switches back to line mode.
+     * @param ctx User context passed to the callback.
+     */
+    void setRxCallback(HC15RxCallback cb, void *ctx = nullptr)
+    {
+        rx_ctx_ = ctx;
+        rx_cb_ = cb;
+    }
+
+    /*
+     * @brief Send raw bytes over the air in transparent mode.
+     * @param data The bytes to send.
+     * @param len The number of bytes.
+     * @param timeout_ms The maximum time to wait for the module to become idle; 0 means use timeout_.
+     * @return The number of bytes written, or 0 if the module stayed busy or the semaphore timed out.
+     */
+    int send(const uint8_t *data, size_t len, uint32_t timeout_ms = 0)
+    {
+        if (!serial_ || !data || len == 0)
+            return 0;
+        if (timeout_ms == 0)
+            timeout_ms = timeout_;
+        if (xSemaphoreTake(hc15_buzy_semaphore_, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+            return 0;
+
+        auto time1 = millis();
+        while (isBuzy() && millis() - time1 < timeout_ms)
+            vTaskDelay(1); // STA 低 = 模块正在收/发，等它空闲
+        int written = isBuzy() ? 0 : serial_->write(data, len);
+
+        xSemaphoreGive(hc15_buzy_semaphore_);
+        return written;
+    }
+
     String readLine()
+    {
+        HC15RxStamp stamp;
+        return readLine(stamp);
+    }
+
+    /*
+     * @brief Read a line together with the capture time of its first and last byte.
+     * @param stamp Receives the timestamps, left at 0 for an empty line.
+     */
+    String readLine(HC15RxStamp &stamp)
     {
         int idx = readBuffer.indexOf('\n');
         if (idx == -1)
@@ -106,15 +363,19 @@ public:
         if (idx != -1)
         {
             String line = readBuffer.substring(0, idx);
+            stampLine(line.length(), stamp);
             // Remove the line (and the newline character) from the buffer
             readBuffer = readBuffer.substring(idx + 1);
+            consumeRx(idx + 1);
             return line;
         }
         else if (readBuffer.length() > 0)
         {
             // No newline found, return all and clear buffer
             String line = readBuffer;
+            stampLine(line.length(), stamp);
             readBuffer = "";
+            consumeRx(line.length());
             return line;
         }
         return String();
@@ -126,7 +387,22 @@ public:
      */
     bool isBuzy()
     {
-        return digitalRead(sta_pin_) == LOW; // ggLOW means busy
+        return !sta_.read(); // LOW means busy, called in tight wait loops
+    }
+
+    /*
+     * @brief STA check before an AT command, shared with HC15Static::command(): watch STA for up to
+     *        timeout_ms and give up as soon as the module reports busy.
+     * @param busy Callable returning true while STA says busy.
+     * @return true if the command may be written.
+     */
+    template <typename BusyFn>
+    static bool commandReady(BusyFn busy, uint32_t timeout_ms)
+    {
+        auto time1 = millis();
+        while (millis() - time1 < timeout_ms && !busy())
+            ;
+        return !busy();
     }
 
     /*
@@ -170,7 +446,7 @@ public:
             }
             else
             {
-                Serial.println("getBaudRate failed, response: " + line);
+                HC15_LOG("getBaudRate failed, response: " + line);
                 xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
                 return "ERROR RESPONSE";
             }
@@ -198,7 +474,7 @@ public:
             else
             {
                 xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
-                Serial.println("getParityBit failed, response: " + line);
+                HC15_LOG("getParityBit failed, response: " + line);
                 return "ERROR RESPONSE";
             }
         }
@@ -229,7 +505,7 @@ public:
                 else
                 {
                     xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
-                    Serial.println("setParityBit failed, response: " + line);
+                    HC15_LOG("setParityBit failed, response: " + line);
                     return "ERROR RESPONSE";
                 }
             }
@@ -259,7 +535,7 @@ public:
             else
             {
                 xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
-                Serial.println("getStopBit failed, response: " + line);
+                HC15_LOG("getStopBit failed, response: " + line);
                 return "ERROR RESPONSE";
             }
         }
@@ -291,7 +567,7 @@ public:
                 else
                 {
                     xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
-                    Serial.println("setStopBit failed, response: " + line);
+                    HC15_LOG("setStopBit failed, response: " + line);
                     return "ERROR RESPONSE";
                 }
             }
@@ -319,7 +595,7 @@ public:
             else
             {
                 xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
-                Serial.println("getChannel failed, response: " + line);
+                HC15_LOG("getChannel failed, response: " + line);
                 return "ERROR RESPONSE";
             }
         }
@@ -350,7 +626,7 @@ public:
                 else
                 {
                     xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
-                    Serial.println("GetChannel failed, response: " + line);
+                    HC15_LOG("GetChannel failed, response: " + line);
                     return "ERROR RESPONSE";
                 }
             }
@@ -379,7 +655,7 @@ public:
             else
             {
                 xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
-                Serial.println("getSpeed failed, response: " + line);
+                HC15_LOG("getSpeed failed, response: " + line);
                 return "ERROR RESPONSE";
             }
         }
@@ -404,13 +680,15 @@ public:
                 String line = _expectLine(timeout_ms);
                 if (line.startsWith("OK+S:"))
                 {
+                    air_bps_ = airBps(speed); // 阈值、超时跟着空速走
+                    applyRxTuning();
                     xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
                     return line.substring(5);
                 }
                 else
                 {
                     xSemaphoreGive(hc15_buzy_semaphore_); // release the semaphore after reading
-                    Serial.println("setSpeed failed, response: " + line);
+                    HC15_LOG("setSpeed failed, response: " + line);
                     return "ERROR RESPONSE";
                 }
             }
@@ -434,14 +712,14 @@ public:
 
         if (xSemaphoreTake(hc15_buzy_semaphore_, pdMS_TO_TICKS(10000)) != pdTRUE)
         {
-            Serial.println("[HC15] getBasicParams: SEMAPHORE TIMEOUT");
+            HC15_LOG("[HC15] getBasicParams: SEMAPHORE TIMEOUT");
             return info;
         }
 
         /* 1. 发命令 */
         if (writeCommand("AT+RX\r\n") <= 0)
         {
-            Serial.println("[HC15] write AT+RX failed");
+            HC15_LOG("[HC15] write AT+RX failed");
             return info;
         }
 
@@ -484,7 +762,7 @@ public:
 
         if (linesGot < 4)
         {
-            Serial.println("[HC15] getBasicParams timeout/incomplete");
+            HC15_LOG("[HC15] getBasicParams timeout/incomplete");
         }
         return info; // 失败时字段有可能为 0，自行判
     }
@@ -504,10 +782,7 @@ private:
         // Ensure the key pin is set high before sending commands
         if (timeout_ms == 0) // if timeout is not set, use the default timeout
             timeout_ms = timeout_;
-        auto time1 = millis();
-        while (millis() - time1 < timeout_ms && !isBuzy())
-            ;
-        if (isBuzy())
+        if (!commandReady([this]() { return isBuzy(); }, timeout_ms))
             return 0;
         if (serial_ && str)
         {
@@ -528,9 +803,9 @@ private:
      */
     int writeCommand(const char *command, uint32_t timeout_ms = 0)
     {
-        digitalWrite(key_pin_, LOW); // Set key pin high to send commands
+        key_.low(); // Set key pin low to send commands
         int result = write(command, timeout_ms);
-        digitalWrite(key_pin_, HIGH);
+        key_.high();
         return result;
     }
 
@@ -568,7 +843,7 @@ private:
                         // 未命中：按需回流 / 丢弃
                         if (spill_to_buf)
                         {
-                            readBuffer += line + '\n';
+                            appendRx(line + '\n', takeRxStamp(line.length() + 1));
                         }
                         line.clear();
                     }
@@ -585,7 +860,7 @@ private:
         // 超时：把半行残余也按需回流
         if (spill_to_buf && line.length())
         {
-            readBuffer += line;
+            appendRx(line, takeRxStamp(line.length()));
         }
         return false;
     }
@@ -618,6 +893,146 @@ private:
         return line;
     }
 
+    /*
+     * @brief UART event task, RX timeout: everything buffered now is one air packet.
+     */
+    void onBurstEnd()
+    {
+        int64_t now = esp_timer_get_time();
+        // 等发送 / 命令放锁；命令回复在锁内已被读走，剩下的才是数据
+        if (xSemaphoreTake(hc15_buzy_semaphore_, pdMS_TO_TICKS(timeout_)) != pdTRUE)
+            return;
+        size_t total = serial_->available();
+        xSemaphoreGive(hc15_buzy_semaphore_);
+        if (total == 0)
+            return;
+
+        // 超时在最后一个字节之后 idle_chars 个字符时间才触发
+        int64_t first_us = now - static_cast<int64_t>(burst_idle_chars_ + total - 1) * charUs();
+        burst_frames_++;
+        for (size_t done = 0; done < total;)
+        {
+            if (done)
+                burst_splits_++; // 比 HC15_BURST_MAX 长，分段交出
+            size_t want = total - done > sizeof(burst_buf_) ? sizeof(burst_buf_) : total - done;
+            xSemaphoreTake(hc15_buzy_semaphore_, portMAX_DELAY);
+            size_t n = serial_->read(burst_buf_, want);
+            xSemaphoreGive(hc15_buzy_semaphore_);
+            if (n == 0)
+                break;
+            rx_chunk_stamp_.first_us = first_us + static_cast<int64_t>(done) * charUs();
+            rx_chunk_stamp_.last_us = rx_chunk_stamp_.first_us + static_cast<int64_t>(n - 1) * charUs();
+            rx_chunk_len_ = n;
+            burst_cb_(burst_buf_, n, burst_ctx_);
+            done += n;
+        }
+    }
+
+    /*
+     * @brief UART event task: open a burst on the first event, move its end on every event.
+     */
+    void onUartEvent()
+    {
+        int64_t now = esp_timer_get_time();
+        int avail = serial_->available();
+        portENTER_CRITICAL(&rx_stamp_mux_);
+        if (!burst_open_)
+        {
+            burst_.first_us = now - (avail > 1 ? avail - 1 : 0) * charUs(); // 事件时 FIFO 里已有 avail 字节
+            burst_open_ = true;
+        }
+        burst_.last_us = now;
+        portEXIT_CRITICAL(&rx_stamp_mux_);
+    }
+
+    /*
+     * @brief Stamp for the len bytes just read, closes the burst once the UART is drained.
+     */
+    HC15RxStamp takeRxStamp(size_t len)
+    {
+        HC15RxStamp stamp;
+        portENTER_CRITICAL(&rx_stamp_mux_);
+        bool open = burst_open_;
+        stamp = burst_;
+        portEXIT_CRITICAL(&rx_stamp_mux_);
+        if (!open)
+        {
+            // 没收到事件（命令模式读走了等），退化为读取时刻
+            stamp.last_us = esp_timer_get_time();
+            stamp.first_us = stamp.last_us - static_cast<int64_t>(len ? len - 1 : 0) * charUs();
+            return stamp;
+        }
+        if (serial_->available() == 0)
+        {
+            portENTER_CRITICAL(&rx_stamp_mux_);
+            if (burst_.last_us == stamp.last_us)
+                burst_open_ = false; // 期间没有新事件才关，否则新突发的首字节时间会丢
+            portEXIT_CRITICAL(&rx_stamp_mux_);
+        }
+        return stamp;
+    }
+
+    int64_t charUs() const { return 10000000ll / baud_rate_; } // 8N1 一个字符 10 bit
+
+    /*
+     * @brief Time of the byte that is back bytes before the last one of a stamped chunk.
+     */
+    int64_t byteTime(const HC15RxStamp &stamp, size_t back) const
+    {
+        int64_t t = stamp.last_us - static_cast<int64_t>(back) * charUs();
+        return t < stamp.first_us ? stamp.first_us : t;
+    }
+
+    void appendRx(const String &data, const HC15RxStamp &stamp)
+    {
+        if (data.length() == 0)
+            return;
+        readBuffer.reserve(readBuffer.length() + data.length());
+        readBuffer += data;
+        rx_in_ += data.length();
+        if (rx_chunk_count_ == HC15_RX_STAMPS)
+        {
+            rx_chunk_head_ = (rx_chunk_head_ + 1) % HC15_RX_STAMPS; // 最旧的批次并入下一批
+            rx_chunk_count_--;
+        }
+        RxChunk &c = rx_chunks_[(rx_chunk_head_ + rx_chunk_count_) % HC15_RX_STAMPS];
+        c.end = rx_in_;
+        c.stamp = stamp;
+        rx_chunk_count_++;
+    }
+
+    /*
+     * @brief Capture time of the byte at stream position pos (counted over everything appended).
+     */
+    int64_t stampAt(uint32_t pos) const
+    {
+        for (uint8_t i = 0; i < rx_chunk_count_; i++)
+        {
+            const RxChunk &c = rx_chunks_[(rx_chunk_head_ + i) % HC15_RX_STAMPS];
+            if (static_cast<int32_t>(c.end - pos) > 0)
+                return byteTime(c.stamp, c.end - 1 - pos);
+        }
+        return 0;
+    }
+
+    void stampLine(size_t len, HC15RxStamp &stamp) const
+    {
+        if (len == 0)
+            return;
+        stamp.first_us = stampAt(rx_out_);
+        stamp.last_us = stampAt(rx_out_ + len - 1);
+    }
+
+    void consumeRx(size_t len)
+    {
+        rx_out_ += len;
+        while (rx_chunk_count_ && static_cast<int32_t>(rx_chunks_[rx_chunk_head_].end - rx_out_) <= 0)
+        {
+            rx_chunk_head_ = (rx_chunk_head_ + 1) % HC15_RX_STAMPS;
+            rx_chunk_count_--;
+        }
+    }
+
     String channelConvertString(uint8_t channel)
     {
         if (channel >= 1 && channel < 10)
@@ -631,6 +1046,18 @@ private:
         return "028";
     }
 
+    /*
+     * @brief Write the profile's FIFO threshold and RX timeout, unless burst mode owns them.
+     */
+    void applyRxTuning()
+    {
+        if (!serial_ || !began_ || burst_cb_)
+            return; // 突发模式要的是空闲间隔超时和 120 阈值，关掉时再恢复
+        HC15UartSettings uart = uartSettings(uart_profile_, baud_rate_, air_bps_);
+        serial_->setRxFIFOFull(uart.rx_fifo_full);
+        serial_->setRxTimeout(uart.rx_timeout);
+    }
+
     // Add private members or methods if needed
     HardwareSerial *serial_ = nullptr;
     uint32_t baud_rate_ = 9600; // Default baud rate
@@ -639,4 +1066,36 @@ private:
     uint8_t sta_pin_ = 12;      // Default status pin
     uint8_t key_pin_ = 18;      // Default key pin need to set high when send commands
     uint32_t timeout_ = 5000;
+    HC15_UART_PROFILE uart_profile_ = HC15_UART_PROFILE::BALANCED;
+    uint32_t air_bps_ = 0;
+    bool began_ = false;
+    HC15FastPin sta_;
+    HC15FastPin key_;
+
+    HC15RxCallback rx_cb_ = nullptr;
+    void *rx_ctx_ = nullptr;
+    uint8_t rx_chunk_[128]; // monitorTask 的二进制搬运缓冲
+    HC15RxStamp rx_chunk_stamp_;
+    size_t rx_chunk_len_ = 0;
+
+    struct RxChunk
+    {
+        uint32_t end; // 该批最后一个字节之后的流位置
+        HC15RxStamp stamp;
+    };
+    portMUX_TYPE rx_stamp_mux_ = portMUX_INITIALIZER_UNLOCKED;
+    HC15RxStamp burst_; // UART 事件维护的当前突发
+    bool burst_open_ = false;
+    RxChunk rx_chunks_[HC15_RX_STAMPS];
+    uint8_t rx_chunk_head_ = 0;
+    uint8_t rx_chunk_count_ = 0;
+    uint32_t rx_in_ = 0;  // 累计写入 readBuffer 的字节
+    uint32_t rx_out_ = 0; // 累计被 readLine 取走的字节
+
+    HC15RxCallback burst_cb_ = nullptr;
+    void *burst_ctx_ = nullptr;
+    uint8_t burst_idle_chars_ = HC15_BURST_IDLE_CHARS;
+    uint8_t burst_buf_[HC15_BURST_MAX];
+    uint32_t burst_frames_ = 0;
+    uint32_t burst_splits_ = 0;
 };
\ No newline at end of file
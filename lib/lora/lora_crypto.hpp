@@ -0,0 +1,82 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * AES-CTR payload encryption for the frame path.
+ *
+ * Uses the mbedtls AES API: on target Arduino's mbedtls is built with MBEDTLS_AES_ALT, so the calls
+ * land on the ESP32-C3 AES peripheral; other builds (Linux host tools) use software mbedtls. CTR needs
+ * no padding and works in place, so a frame only grows by the epoch that makes the nonce unique:
+ *   counter block = SRC(2) | EPOCH(4) | SEQ(2) | DOMAIN(1) | 0(3) | BLOCK(4, big endian)
+ * SRC / SEQ are already in the header, EPOCH is random per boot and bumped on every SEQ wrap.
+ */
+
+#include <mbedtls/aes.h>
+
+#define HC15_CRYPTO_EPOCH_LEN 4 // 每帧附加的 nonce 字节
+#define HC15_CRYPTO_DOMAIN_PAYLOAD 0x00
+
+class HC15Cipher
+{
+public:
+    HC15Cipher()
+    {
+        mbedtls_aes_init(&aes_);
+    }
+
+    ~HC15Cipher()
+    {
+        mbedtls_aes_free(&aes_);
+    }
+
+    HC15Cipher(const HC15Cipher &) = delete;
+    HC15Cipher &operator=(const HC15Cipher &) = delete;
+
+    /*
+     * @brief Load the network key.
+     * @param bits 128 or 256.
+     */
+    bool setKey(const uint8_t *key, uint16_t bits)
+    {
+        if (!key || (bits != 128 && bits != 256))
+            return false;
+        ready_ = mbedtls_aes_setkey_enc(&aes_, key, bits) == 0;
+        return ready_;
+    }
+
+    bool ready() const { return ready_; }
+
+    /*
+     * @brief Encrypt / decrypt data in place (CTR is symmetric).
+     */
+    bool ctr(uint16_t src, uint32_t epoch, uint16_t seq, uint8_t *data, size_t len, uint8_t domain = HC15_CRYPTO_DOMAIN_PAYLOAD)
+    {
+        if (!ready_)
+            return false;
+        uint8_t counter[16] = {0};
+        counter[0] = static_cast<uint8_t>(src);
+        counter[1] = static_cast<uint8_t>(src >> 8);
+        for (uint8_t i = 0; i < 4; i++)
+            counter[2 + i] = static_cast<uint8_t>(epoch >> (8 * i));
+        counter[6] = static_cast<uint8_t>(seq);
+        counter[7] = static_cast<uint8_t>(seq >> 8);
+        counter[8] = domain;
+        uint8_t stream[16];
+        size_t off = 0;
+        return mbedtls_aes_crypt_ctr(&aes_, len, &off, counter, stream, data, data) == 0;
+    }
+
+    /*
+     * @brief Encrypt a single 16-byte block (CMAC building block).
+     */
+    bool block(const uint8_t in[16], uint8_t out[16])
+    {
+        return ready_ && mbedtls_aes_crypt_ecb(&aes_, MBEDTLS_AES_ENCRYPT, in, out) == 0;
+    }
+
+private:
+    mbedtls_aes_context aes_;
+    bool ready_ = false;
+};
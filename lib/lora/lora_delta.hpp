@@ -0,0 +1,329 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <lora_blob.hpp>
+#include <lora_sha256.hpp>
+
+/*
+ * Delta patch decoder for the firmware update (lora_ota.hpp); no Arduino dependency, so the host
+ * tools and tests use it as is.
+ *
+ * Patch format, multi-byte fields little endian:
+ *   header: "HCDP" | base size(4) | base sha256(32) | target size(4) | target sha256(32)
+ *   ops until target size bytes are produced, lengths are LEB128 varints (at most 32 bits):
+ *     0 COPY    len         copy len old bytes from the old cursor
+ *     1 ADD     len, body   new = old + diff (mod 256) for len bytes, bsdiff style approximate match
+ *     2 INSERT  len, bytes  literal new bytes, old cursor unchanged
+ *     3 SEEK    zigzag d    move the old cursor by d
+ *   ADD body, zero-run coded: a non-zero byte is one diff, 0 followed by varint n is n zero diffs.
+ * Recompiled code mostly matches the old image except for shifted addresses, so its ADD diffs are
+ * long zero runs with a few scattered bytes, and only genuinely new code travels as INSERT.
+ * tools/hc15_delta.cpp generates patches.
+ */
+
+#define HC15_DELTA_MAGIC "HCDP"
+#define HC15_DELTA_HEADER_LEN 76
+#define HC15_DELTA_BLOCK 256 // 旧镜像 / 输出的缓冲块大小
+
+enum class HC15_DELTA_OP : uint8_t
+{
+    COPY = 0,
+    ADD = 1,
+    INSERT = 2,
+    SEEK = 3,
+};
+
+enum class HC15_OTA_RESULT
+{
+    NONE = 0,
+    OK = 1,
+    BAD_PATCH = 2,
+    BASE_MISMATCH = 3, // 补丁不是针对当前运行的固件做的
+    HASH_MISMATCH = 4,
+    FLASH_ERROR = 5,
+    READ_ERROR = 6,
+};
+
+struct HC15DeltaHeader
+{
+    uint32_t base_size;
+    uint8_t base_sha256[32];
+    uint32_t target_size;
+    uint8_t target_sha256[32];
+
+    static uint32_t get32(const uint8_t *p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    bool parse(const uint8_t *raw)
+    {
+        if (memcmp(raw, HC15_DELTA_MAGIC, 4) != 0)
+            return false;
+        base_size = get32(raw + 4);
+        memcpy(base_sha256, raw + 8, 32);
+        target_size = get32(raw + 40);
+        memcpy(target_sha256, raw + 44, 32);
+        return target_size > 0;
+    }
+};
+
+/*
+ * Streaming delta decoder: feed() the patch body (after the header) in any split, output is written
+ * strictly in order and hashed on the way.
+ */
+class HC15DeltaApplier
+{
+public:
+    void begin(const HC15DeltaHeader &header, HC15BlobReader old_reader, void *old_ctx, HC15BlobWriter out_writer, void *out_ctx)
+    {
+        header_ = header;
+        old_reader_ = old_reader;
+        old_ctx_ = old_ctx;
+        out_writer_ = out_writer;
+        out_ctx_ = out_ctx;
+        state_ = State::OP;
+        varint_ = 0;
+        shift_ = 0;
+        remaining_ = 0;
+        old_pos_ = 0;
+        out_pos_ = 0;
+        out_fill_ = 0;
+        error_ = HC15_OTA_RESULT::NONE;
+        if (!sha_.starts())
+            error_ = HC15_OTA_RESULT::HASH_MISMATCH;
+    }
+
+    /*
+     * @return false once the patch turned out to be invalid or I/O failed, see result().
+     */
+    bool feed(const uint8_t *data, size_t len)
+    {
+        size_t i = 0;
+        while (i < len && error_ == HC15_OTA_RESULT::NONE)
+        {
+            switch (state_)
+            {
+            case State::OP:
+                op_ = static_cast<HC15_DELTA_OP>(data[i++]);
+                if (static_cast<uint8_t>(op_) > static_cast<uint8_t>(HC15_DELTA_OP::SEEK))
+                    return fail(HC15_OTA_RESULT::BAD_PATCH);
+                varint_ = 0;
+                shift_ = 0;
+                state_ = State::VARINT;
+                break;
+
+            case State::VARINT:
+            case State::RUN:
+            {
+                uint8_t c = data[i++];
+                // 第 5 个字节只剩 4 位可用，再高的位或第 6 个字节都会溢出 32 位
+                if (shift_ > 28 || (shift_ == 28 && (c & 0x70)))
+                    return fail(HC15_OTA_RESULT::BAD_PATCH);
+                varint_ |= static_cast<uint32_t>(c & 0x7F) << shift_;
+                shift_ += 7;
+                if (c & 0x80)
+                    break;
+                if (!(state_ == State::RUN ? zeroRun() : startOp()))
+                    return false;
+                break;
+            }
+
+            case State::DATA:
+                if (op_ == HC15_DELTA_OP::ADD)
+                {
+                    if (!addDiffs(data, len, i))
+                        return false;
+                    break;
+                }
+                {
+                    size_t n = len - i < remaining_ ? len - i : remaining_;
+                    if (!emit(data + i, n))
+                        return false;
+                    i += n;
+                    remaining_ -= n;
+                    if (remaining_ == 0)
+                        state_ = State::OP;
+                }
+                break;
+            }
+        }
+        return error_ == HC15_OTA_RESULT::NONE;
+    }
+
+    /*
+     * @brief Flush the output and check size and hash against the header.
+     */
+    HC15_OTA_RESULT finish()
+    {
+        if (error_ == HC15_OTA_RESULT::NONE)
+        {
+            if (state_ != State::OP || out_pos_ + out_fill_ != header_.target_size)
+                error_ = HC15_OTA_RESULT::BAD_PATCH;
+            else if (flush())
+            {
+                uint8_t sha[32];
+                error_ = sha_.finish(sha) && memcmp(sha, header_.target_sha256, 32) == 0 ? HC15_OTA_RESULT::OK
+                                                                                         : HC15_OTA_RESULT::HASH_MISMATCH;
+            }
+        }
+        return error_;
+    }
+
+    uint32_t produced() const { return out_pos_ + out_fill_; }
+    HC15_OTA_RESULT result() const { return error_; }
+
+private:
+    enum class State : uint8_t
+    {
+        OP,
+        VARINT,
+        DATA,
+        RUN, // ADD 内零差值游程的长度
+    };
+
+    bool startOp()
+    {
+        switch (op_)
+        {
+        case HC15_DELTA_OP::COPY:
+            if (!copyOld(varint_))
+                return false;
+            state_ = State::OP;
+            return true;
+        case HC15_DELTA_OP::SEEK:
+        {
+            int32_t d = static_cast<int32_t>(varint_ >> 1) ^ -static_cast<int32_t>(varint_ & 1);
+            int64_t pos = static_cast<int64_t>(old_pos_) + d;
+            if (pos < 0 || pos > header_.base_size)
+                return fail(HC15_OTA_RESULT::BAD_PATCH);
+            old_pos_ = static_cast<uint32_t>(pos);
+            state_ = State::OP;
+            return true;
+        }
+        default:
+            remaining_ = varint_;
+            state_ = remaining_ ? State::DATA : State::OP;
+            return true;
+        }
+    }
+
+    /*
+     * @brief One step of an ADD body: a run of literal (non-zero) diffs, or the start of a zero run.
+     */
+    bool addDiffs(const uint8_t *data, size_t len, size_t &i)
+    {
+        if (data[i] == 0)
+        {
+            i++;
+            varint_ = 0;
+            shift_ = 0;
+            state_ = State::RUN;
+            return true;
+        }
+        // 连续的非零差值一次读旧字节、相加
+        uint8_t old[HC15_DELTA_BLOCK];
+        size_t m = 0;
+        while (m < sizeof(old) && m < remaining_ && i + m < len && data[i + m])
+            m++;
+        if (!readOld(old, m))
+            return false;
+        for (size_t k = 0; k < m; k++)
+            old[k] += data[i + k];
+        if (!emit(old, m))
+            return false;
+        i += m;
+        remaining_ -= m;
+        if (remaining_ == 0)
+            state_ = State::OP;
+        return true;
+    }
+
+    bool zeroRun()
+    {
+        if (varint_ == 0 || varint_ > remaining_)
+            return fail(HC15_OTA_RESULT::BAD_PATCH);
+        if (!copyOld(varint_))
+            return false;
+        remaining_ -= varint_;
+        state_ = remaining_ ? State::DATA : State::OP;
+        return true;
+    }
+
+    bool copyOld(uint32_t len)
+    {
+        uint8_t old[HC15_DELTA_BLOCK];
+        while (len)
+        {
+            size_t m = len < sizeof(old) ? len : sizeof(old);
+            if (!readOld(old, m) || !emit(old, m))
+                return false;
+            len -= m;
+        }
+        return true;
+    }
+
+    bool readOld(uint8_t *out, size_t len)
+    {
+        if (old_pos_ + len > header_.base_size)
+            return fail(HC15_OTA_RESULT::BAD_PATCH);
+        if (old_reader_(old_pos_, out, len, old_ctx_) != len)
+            return fail(HC15_OTA_RESULT::READ_ERROR);
+        old_pos_ += len;
+        return true;
+    }
+
+    bool emit(const uint8_t *data, size_t len)
+    {
+        if (out_pos_ + out_fill_ + len > header_.target_size)
+            return fail(HC15_OTA_RESULT::BAD_PATCH);
+        while (len)
+        {
+            size_t m = sizeof(out_) - out_fill_ < len ? sizeof(out_) - out_fill_ : len;
+            memcpy(out_ + out_fill_, data, m);
+            out_fill_ += m;
+            data += m;
+            len -= m;
+            if (out_fill_ == sizeof(out_) && !flush())
+                return false;
+        }
+        return true;
+    }
+
+    bool flush()
+    {
+        if (!out_fill_)
+            return true;
+        if (!sha_.update(out_, out_fill_))
+            return fail(HC15_OTA_RESULT::HASH_MISMATCH);
+        if (!out_writer_(out_pos_, out_, out_fill_, out_ctx_))
+            return fail(HC15_OTA_RESULT::FLASH_ERROR);
+        out_pos_ += out_fill_;
+        out_fill_ = 0;
+        return true;
+    }
+
+    bool fail(HC15_OTA_RESULT r)
+    {
+        error_ = r;
+        return false;
+    }
+
+    HC15DeltaHeader header_;
+    HC15BlobReader old_reader_ = nullptr;
+    void *old_ctx_ = nullptr;
+    HC15BlobWriter out_writer_ = nullptr;
+    void *out_ctx_ = nullptr;
+    State state_ = State::OP;
+    HC15_DELTA_OP op_ = HC15_DELTA_OP::COPY;
+    uint32_t varint_ = 0;
+    uint8_t shift_ = 0;
+    uint32_t remaining_ = 0;
+    uint32_t old_pos_ = 0;
+    uint32_t out_pos_ = 0;
+    size_t out_fill_ = 0;
+    uint8_t out_[HC15_DELTA_BLOCK];
+    HC15Sha256 sha_;
+    HC15_OTA_RESULT error_ = HC15_OTA_RESULT::NONE;
+};
@@ -0,0 +1,208 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Shortened Reed-Solomon code over GF(256) (poly 0x11D, first consecutive root alpha^0).
+ * npar parity bytes correct up to npar / 2 byte errors anywhere in a block of at most 255 bytes.
+ * Tables are built once on first use (768 bytes RAM), a clean block costs only the syndrome pass.
+ */
+
+#define HC15_RS_MAX_PARITY 32
+
+class HC15ReedSolomon
+{
+public:
+    /*
+     * @brief Compute npar parity bytes for data[0..k).
+     */
+    static void encode(const uint8_t *data, size_t k, uint8_t *parity, uint8_t npar)
+    {
+        const Tables &t = tables();
+        uint8_t gen[HC15_RS_MAX_PARITY + 1];
+        generator(npar, gen);
+
+        memset(parity, 0, npar);
+        for (size_t i = 0; i < k; i++)
+        {
+            uint8_t fb = data[i] ^ parity[0];
+            if (fb)
+            {
+                uint8_t lfb = t.log[fb];
+                for (uint8_t j = 0; j + 1 < npar; j++)
+                    parity[j] = parity[j + 1] ^ (gen[j + 1] ? t.exp[lfb + t.log[gen[j + 1]]] : 0);
+                parity[npar - 1] = gen[npar] ? t.exp[lfb + t.log[gen[npar]]] : 0;
+            }
+            else
+            {
+                memmove(parity, parity + 1, npar - 1);
+                parity[npar - 1] = 0;
+            }
+        }
+    }
+
+    /*
+     * @brief Correct a block (data followed by npar parity bytes) in place.
+     * @param n Total block length, at most 255.
+     * @return The number of corrected bytes, or -1 if the block is uncorrectable.
+     */
+    static int decode(uint8_t *block, size_t n, uint8_t npar)
+    {
+        if (npar == 0 || npar > HC15_RS_MAX_PARITY || n > 255 || n <= npar)
+            return -1;
+        const Tables &t = tables();
+
+        uint8_t synd[HC15_RS_MAX_PARITY];
+        bool clean = true;
+        for (uint8_t j = 0; j < npar; j++)
+        {
+            uint8_t s = 0;
+            for (size_t i = 0; i < n; i++)
+                s = (s ? t.exp[t.log[s] + j] : 0) ^ block[i]; // Horner, x = alpha^j
+            synd[j] = s;
+            clean &= (s == 0);
+        }
+        if (clean)
+            return 0; // 快速路径：无误码
+
+        // Berlekamp-Massey -> error locator lambda
+        uint8_t lambda[HC15_RS_MAX_PARITY + 1] = {1};
+        uint8_t prev[HC15_RS_MAX_PARITY + 1] = {1};
+        uint8_t tmp[HC15_RS_MAX_PARITY + 1];
+        uint8_t L = 0, m = 1, b = 1;
+        for (uint8_t r = 0; r < npar; r++)
+        {
+            uint8_t d = synd[r];
+            for (uint8_t i = 1; i <= L; i++)
+                d ^= mul(lambda[i], synd[r - i]);
+            if (d == 0)
+            {
+                m++;
+                continue;
+            }
+            uint8_t coef = div(d, b);
+            memcpy(tmp, lambda, sizeof(tmp));
+            for (uint8_t i = 0; i + m <= npar; i++)
+                lambda[i + m] ^= mul(coef, prev[i]);
+            if (2 * L <= r)
+            {
+                L = r + 1 - L;
+                memcpy(prev, tmp, sizeof(prev));
+                b = d;
+                m = 1;
+            }
+            else
+            {
+                m++;
+            }
+        }
+        if (2 * L > npar)
+            return -1;
+
+        // omega = synd * lambda mod x^npar
+        uint8_t omega[HC15_RS_MAX_PARITY];
+        for (uint8_t i = 0; i < npar; i++)
+        {
+            uint8_t v = 0;
+            for (uint8_t j = 0; j <= i && j <= L; j++)
+                v ^= mul(lambda[j], synd[i - j]);
+            omega[i] = v;
+        }
+
+        // Chien search + Forney
+        int found = 0;
+        for (size_t pos = 0; pos < n; pos++)
+        {
+            uint8_t power = static_cast<uint8_t>(n - 1 - pos); // 该字节对应的 x 次数
+            uint8_t xinv_log = static_cast<uint8_t>((255 - power) % 255);
+
+            uint8_t val = 0, deriv = 0;
+            for (uint8_t i = 0; i <= L; i++)
+            {
+                if (!lambda[i])
+                    continue;
+                uint8_t term = t.exp[t.log[lambda[i]] + (xinv_log * i) % 255];
+                val ^= term;
+                if (i & 1)
+                    deriv ^= t.exp[t.log[lambda[i]] + (xinv_log * (i - 1)) % 255];
+            }
+            if (val != 0)
+                continue;
+            if (deriv == 0)
+                return -1;
+
+            uint8_t om = 0;
+            for (uint8_t i = 0; i < npar; i++)
+            {
+                if (omega[i])
+                    om ^= t.exp[t.log[omega[i]] + (xinv_log * i) % 255];
+            }
+            // e = X * omega(X^-1) / lambda'(X^-1)
+            uint8_t e = om ? t.exp[(t.log[om] + power + 255 - t.log[deriv]) % 255] : 0;
+            block[pos] ^= e;
+            found++;
+        }
+        return (found == L) ? found : -1;
+    }
+
+private:
+    struct Tables
+    {
+        uint8_t exp[512];
+        uint8_t log[256];
+
+        Tables()
+        {
+            uint16_t x = 1;
+            for (uint16_t i = 0; i < 255; i++)
+            {
+                exp[i] = static_cast<uint8_t>(x);
+                log[x] = static_cast<uint8_t>(i);
+                x <<= 1;
+                if (x & 0x100)
+                    x ^= 0x11D;
+            }
+            for (uint16_t i = 255; i < 512; i++)
+                exp[i] = exp[i - 255];
+            log[0] = 0;
+        }
+    };
+
+    static const Tables &tables()
+    {
+        static Tables t;
+        return t;
+    }
+
+    static uint8_t mul(uint8_t a, uint8_t b)
+    {
+        if (!a || !b)
+            return 0;
+        const Tables &t = tables();
+        return t.exp[t.log[a] + t.log[b]];
+    }
+
+    static uint8_t div(uint8_t a, uint8_t b)
+    {
+        if (!a)
+            return 0;
+        const Tables &t = tables();
+        return t.exp[t.log[a] + 255 - t.log[b]];
+    }
+
+    /*
+     * @brief g(x) = prod (x - alpha^i), i = 0..npar-1, gen[0] is the x^npar coefficient.
+     */
+    static void generator(uint8_t npar, uint8_t *gen)
+    {
+        memset(gen, 0, npar + 1);
+        gen[0] = 1;
+        for (uint8_t i = 0; i < npar; i++)
+        {
+            uint8_t root = tables().exp[i];
+            for (uint8_t j = i + 1; j > 0; j--)
+                gen[j] ^= mul(gen[j - 1], root);
+        }
+    }
+};
@@ -0,0 +1,274 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_link.hpp>
+
+/*
+ * Credit-based flow control between link peers.
+ *
+ * The receiver advertises CREDIT(free, last_seq): free = empty slots in the receive queue of the
+ * flow's port, last_seq = newest frame it has taken from that sender. The sender counts as in flight
+ * only the frames it sent after last_seq, so lost frames never leak credit, and it transmits only
+ * while free - in_flight > 0. When it runs dry it asks with an empty CREDIT.
+ */
+
+#ifndef HC15_FLOW_PEERS
+#define HC15_FLOW_PEERS 8 // 同时做流控的对端数
+#endif
+
+#ifndef HC15_FLOW_INFLIGHT
+#define HC15_FLOW_INFLIGHT 16 // 每个对端记录的已发未确认序号，也是授信上限
+#endif
+
+#ifndef HC15_FLOW_TX_DEPTH
+#define HC15_FLOW_TX_DEPTH 8
+#endif
+
+#define HC15_FLOW_REQUEST_MS 500 // 没额度时多久重新索要一次
+#define HC15_FLOW_INITIAL_CREDIT 1 // 还没收到授信时先探一帧
+
+class HC15FlowControl
+{
+public:
+    HC15FlowControl(HC15Link *link, uint8_t port = HC15_PORT_DEFAULT) : link_(link), port_(port)
+    {
+        tx_queue_ = xQueueCreate(HC15_FLOW_TX_DEPTH, sizeof(HC15Frame));
+        lock_ = xSemaphoreCreateMutex();
+        credit_event_ = xSemaphoreCreateBinary();
+    }
+
+    bool begin()
+    {
+        if (!link_ || !tx_queue_ || !lock_ || !credit_event_)
+            return false;
+        return link_->addHandler(HC15_FRAME_TYPE::CREDIT, &HC15FlowControl::onCredit, this) &&
+               link_->addHandler(HC15_FRAME_TYPE::DATA, &HC15FlowControl::onData, this);
+    }
+
+    /*
+     * @brief Queue a payload for dst, txTask() sends it once dst has granted credit.
+     */
+    bool send(uint16_t dst, const uint8_t *payload, uint8_t len, uint32_t timeout_ms = 0)
+    {
+        if (len > HC15_FRAME_MAX_PAYLOAD || (len && !payload) || dst == HC15_BROADCAST_ID)
+            return false;
+        HC15Frame frame;
+        frame.flags = 0;
+        frame.type = static_cast<uint8_t>(HC15_FRAME_TYPE::DATA);
+        frame.dst = dst;
+        frame.port = port_;
+        frame.len = len;
+        if (len)
+            memcpy(frame.payload, payload, len);
+        return xQueueSend(tx_queue_, &frame, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    }
+
+    /*
+     * @brief Send queued frames as credit allows, use rtos task please.
+     */
+    void txTask(void * /*pvParameters*/)
+    {
+        HC15Frame frame;
+        for (;;)
+        {
+            if (xQueuePeek(tx_queue_, &frame, portMAX_DELAY) != pdTRUE)
+                continue;
+
+            if (credits(frame.dst) <= 0)
+            {
+                requestCredit(frame.dst);
+                xSemaphoreTake(credit_event_, pdMS_TO_TICKS(HC15_FLOW_REQUEST_MS));
+                continue;
+            }
+
+            xQueueReceive(tx_queue_, &frame, 0);
+            if (link_->sendFrame(frame))
+                recordSent(frame.dst, frame.seq);
+            else
+                tx_failed_++;
+        }
+    }
+
+    /*
+     * @brief Receive on the flow's port; hands credit back to the sender as the queue drains.
+     */
+    bool receive(HC15Frame &frame, uint32_t timeout_ms = 0)
+    {
+        if (!link_->receive(port_, frame, timeout_ms))
+            return false;
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        Peer *p = peer(frame.src, true);
+        bool due = false;
+        if (p)
+        {
+            p->consumed++;
+            int depth = link_->space(port_) + link_->available(port_);
+            due = p->consumed >= (depth > 1 ? depth / 2 : 1);
+        }
+        xSemaphoreGive(lock_);
+
+        if (due)
+            grant(frame.src);
+        return true;
+    }
+
+    /*
+     * @brief Tell peer how much room we have right now.
+     */
+    bool grant(uint16_t peer_id)
+    {
+        int space = link_->space(port_);
+        uint8_t payload[3];
+        payload[0] = static_cast<uint8_t>(space > 255 ? 255 : space);
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        Peer *p = peer(peer_id, true);
+        bool seen = p && p->rx_seen;
+        if (p)
+        {
+            HC15FrameCodec::put16(payload + 1, p->last_rx_seq);
+            p->consumed = 0;
+        }
+        xSemaphoreGive(lock_);
+
+        // 还没收到过对方的帧就只通告空位，不带序号
+        return link_->send(peer_id, HC15_FRAME_TYPE::CREDIT, payload, seen ? 3 : 1);
+    }
+
+    /*
+     * @brief Frames we may still send to peer_id before it has to grant more.
+     */
+    int credits(uint16_t peer_id)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        Peer *p = peer(peer_id, false);
+        int left = p ? static_cast<int>(p->free) - inFlight(*p) : HC15_FLOW_INITIAL_CREDIT;
+        xSemaphoreGive(lock_);
+        return left;
+    }
+
+    uint32_t txFailed() const { return tx_failed_; }
+    uint32_t creditRequests() const { return credit_requests_; }
+
+private:
+    struct Peer
+    {
+        uint16_t id;
+        // 发送方向
+        uint8_t free;     // 对端上次通告的空位
+        uint16_t ack_seq; // 对端上次通告时收到的最新序号
+        uint16_t sent[HC15_FLOW_INFLIGHT];
+        uint8_t sent_head;
+        uint8_t sent_count;
+        TickType_t last_request;
+        // 接收方向
+        uint16_t last_rx_seq;
+        bool rx_seen;
+        uint8_t consumed; // 上次授信之后被消费的帧数
+    };
+
+    Peer *peer(uint16_t id, bool create)
+    {
+        for (uint8_t i = 0; i < peer_count_; i++)
+        {
+            if (peers_[i].id == id)
+                return &peers_[i];
+        }
+        if (!create || peer_count_ >= HC15_FLOW_PEERS)
+            return nullptr;
+        Peer &p = peers_[peer_count_++];
+        memset(&p, 0, sizeof(p));
+        p.id = id;
+        p.free = HC15_FLOW_INITIAL_CREDIT;
+        return &p;
+    }
+
+    static int inFlight(const Peer &p)
+    {
+        int n = 0;
+        for (uint8_t i = 0; i < p.sent_count; i++)
+        {
+            uint16_t seq = p.sent[(p.sent_head + HC15_FLOW_INFLIGHT - 1 - i) % HC15_FLOW_INFLIGHT];
+            if (static_cast<int16_t>(seq - p.ack_seq) > 0)
+                n++;
+        }
+        return n;
+    }
+
+    void recordSent(uint16_t dst, uint16_t seq)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        Peer *p = peer(dst, true);
+        if (p)
+        {
+            p->sent[p->sent_head] = seq;
+            p->sent_head = (p->sent_head + 1) % HC15_FLOW_INFLIGHT;
+            if (p->sent_count < HC15_FLOW_INFLIGHT)
+                p->sent_count++;
+            if (p->sent_count == 1)
+                p->ack_seq = seq - 1; // 第一帧之前的都算已确认
+        }
+        xSemaphoreGive(lock_);
+    }
+
+    void requestCredit(uint16_t dst)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        Peer *p = peer(dst, true);
+        TickType_t now = xTaskGetTickCount();
+        bool due = p && (p->last_request == 0 || now - p->last_request >= pdMS_TO_TICKS(HC15_FLOW_REQUEST_MS));
+        if (due)
+            p->last_request = now;
+        xSemaphoreGive(lock_);
+
+        if (due && link_->send(dst, HC15_FRAME_TYPE::CREDIT, nullptr, 0))
+            credit_requests_++;
+    }
+
+    static bool onCredit(const HC15Frame &frame, void *ctx)
+    {
+        HC15FlowControl *self = static_cast<HC15FlowControl *>(ctx);
+        if (frame.len == 0)
+        {
+            self->grant(frame.src); // 对端在索要额度
+            return true;
+        }
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        Peer *p = self->peer(frame.src, true);
+        if (p)
+        {
+            p->free = frame.payload[0] > HC15_FLOW_INFLIGHT ? HC15_FLOW_INFLIGHT : frame.payload[0];
+            if (frame.len >= 3)
+                p->ack_seq = HC15FrameCodec::get16(frame.payload + 1);
+        }
+        xSemaphoreGive(self->lock_);
+        xSemaphoreGive(self->credit_event_);
+        return true;
+    }
+
+    static bool onData(const HC15Frame &frame, void *ctx)
+    {
+        HC15FlowControl *self = static_cast<HC15FlowControl *>(ctx);
+        if (frame.port != self->port_)
+            return false;
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        Peer *p = self->peer(frame.src, true);
+        if (p && (!p->rx_seen || static_cast<int16_t>(frame.seq - p->last_rx_seq) > 0))
+        {
+            p->last_rx_seq = frame.seq;
+            p->rx_seen = true;
+        }
+        xSemaphoreGive(self->lock_);
+        return false; // 只记序号，照常入队
+    }
+
+    HC15Link *link_ = nullptr;
+    uint8_t port_ = HC15_PORT_DEFAULT;
+    QueueHandle_t tx_queue_ = nullptr;
+    SemaphoreHandle_t lock_ = nullptr;
+    SemaphoreHandle_t credit_event_ = nullptr;
+    Peer peers_[HC15_FLOW_PEERS];
+    uint8_t peer_count_ = 0;
+    uint32_t tx_failed_ = 0;
+    uint32_t credit_requests_ = 0;
+};
@@ -0,0 +1,463 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <lora_fec.hpp>
+
+/*
+ * Binary framing used on top of the HC-15 transparent UART link.
+ *
+ * wire layout:
+ *   SYNC(1) | LEN(1) | FLAGS(1) | DST(2) | SRC(2) | TYPE(1) | SEQ(2) | PORT(1) | PAYLOAD(LEN - header) | CRC16(2)
+ * LEN counts header + payload, CRC16 (CCITT) covers LEN .. PAYLOAD, multi-byte fields are little endian.
+ * Addressing comes first so a receiver can drop foreign frames after 3 body bytes without buffering them.
+ *
+ * FEC layout (optional, for marginal links):
+ *   SYNC_FEC(1) | MODE(1) | LEN x3 | LEN .. CRC16 as above | RS PARITY(npar)
+ * MODE is one of three codewords 5 bits apart and LEN is sent three times (bitwise majority), so the
+ * receiver knows the block size even with bit errors; the RS code then repairs LEN .. CRC16 in place.
+ *
+ * Secured frames (HC15_FLAG_ENC / HC15_FLAG_MAC) carry a trailer of up to HC15_FRAME_MAX_TRAILER bytes
+ * after the payload, counted in LEN, so services can still use the full HC15_FRAME_MAX_PAYLOAD.
+ * On receive the flags stay set after the trailer is stripped, handlers can require them.
+ */
+
+#ifndef HC15_FRAME_MAX_PAYLOAD
+#define HC15_FRAME_MAX_PAYLOAD 96 // 单帧最大负载，HC-15 单包 UART 突发不宜过长
+#endif
+
+#define HC15_FRAME_MAX_TRAILER 12 // 安全尾部：epoch(4) + MAC tag(<=8)
+#define HC15_FRAME_SYNC 0x7E
+#define HC15_FRAME_HEADER_LEN 9
+#define HC15_FRAME_ADDR_LEN 3 // FLAGS + DST，过滤所需的最少字节
+#define HC15_FRAME_OVERHEAD (2 + HC15_FRAME_HEADER_LEN + 2) // SYNC + LEN + header + CRC
+#define HC15_FRAME_FEC_HEADER_LEN 5 // SYNC_FEC + MODE + LEN x3
+#define HC15_FRAME_MAX_BODY (HC15_FRAME_MAX_PAYLOAD + HC15_FRAME_MAX_TRAILER) // 负载 + 安全尾部
+#define HC15_FRAME_MAX_WIRE (HC15_FRAME_OVERHEAD + HC15_FRAME_MAX_BODY + HC15_FRAME_FEC_HEADER_LEN - 1 + HC15_RS_MAX_PARITY)
+#define HC15_FRAME_SYNC_FEC 0x7D
+
+#ifndef HC15_FRAME_MAX_GROUPS
+#define HC15_FRAME_MAX_GROUPS 4 // 每个节点可加入的组播组数
+#endif
+
+#define HC15_BROADCAST_ID 0xFFFF
+
+#define HC15_FLAG_BCAST 0x01 // 广播，DST 忽略
+#define HC15_FLAG_MCAST 0x02 // 组播，DST 为组 ID
+#define HC15_FLAG_RELAY 0x04 // 允许中继转发
+#define HC15_FLAG_ENC 0x08   // 负载已加密，尾部带 epoch
+#define HC15_FLAG_MAC 0x10   // 尾部带 epoch + CMAC tag
+#define HC15_FLAG_HOPS_SHIFT 5
+#define HC15_FLAG_HOPS_MASK 0xE0 // 剩余跳数 0~7
+
+enum class HC15_FRAME_TYPE : uint8_t
+{
+    DATA = 0,     // application payload
+    POLL = 1,     // gateway -> node, payload[0] = frame budget
+    POLL_END = 2, // node -> gateway, payload[0] = frames still queued
+    CREDIT = 3,   // receiver -> sender: free(1) [+ last seq received(2)]; empty payload = credit request
+    MCAST_CHUNK = 4, // blob(2) + chunk(2) + total(2) + data, to a multicast group
+    MCAST_END = 5,   // blob(2) + total(2) + round(1): end of a (re)broadcast round, NACK now
+    MCAST_NACK = 6,  // blob(2) + first byte(2) + missing-chunk bitmap, to the group so others can suppress
+    XFER_OFFER = 7,  // id(2) + size(4) + sha256(32): start or resume a bulk transfer
+    XFER_CHUNK = 8,  // id(2) + chunk(2) + ctl(1) + data; ctl bit0 = answer with XFER_STATUS
+    XFER_STATUS = 9, // id(2) + first byte(2) + received-chunk bitmap from there
+    XFER_DONE = 10,  // id(2) + result(1): 0 = hash verified
+    TELEM_ACK = 11,  // port(1) + keyframe id(1): telemetry keyframe received, deltas may refer to it
+    PROBE = 12,      // op(1) + fields: link test echo / bulk / speed switch, see lora_probe.hpp
+};
+
+/*
+ * Code rate of the FEC layer, the value is the number of RS parity bytes per frame.
+ */
+enum class HC15_FEC_MODE : uint8_t
+{
+    OFF = 0,
+    LIGHT = 8,   // 纠 4 字节
+    MEDIUM = 16, // 纠 8 字节
+    STRONG = 32, // 纠 16 字节
+};
+
+struct HC15Frame
+{
+    uint8_t flags;
+    uint8_t type;
+    uint16_t dst;
+    uint16_t src;
+    uint16_t seq;
+    uint8_t port; // 逻辑端口，多个服务共用一条链路
+    uint8_t len;  // payload length
+    uint8_t payload[HC15_FRAME_MAX_BODY];
+    int64_t rx_first_us; // 接收时刻（SYNC / 最后一个字节），esp_timer us，发送帧不用
+    int64_t rx_last_us;
+};
+
+class HC15FrameCodec
+{
+public:
+    /*
+     * @brief CRC16-CCITT (poly 0x1021), bitwise so it needs no table in flash.
+     */
+    static uint16_t crc16(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF)
+    {
+        while (len--)
+        {
+            crc ^= static_cast<uint16_t>(*data++) << 8;
+            for (uint8_t i = 0; i < 8; i++)
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+        return crc;
+    }
+
+    /*
+     * @brief Encode a frame into its wire representation.
+     * @param frame The frame to encode.
+     * @param out The output buffer.
+     * @param cap The capacity of the output buffer.
+     * @return The number of bytes written, or 0 if the frame does not fit.
+     */
+    static size_t encode(const HC15Frame &frame, uint8_t *out, size_t cap)
+    {
+        if (frame.len > HC15_FRAME_MAX_BODY)
+            return 0;
+        size_t total = HC15_FRAME_OVERHEAD + frame.len;
+        if (!out || cap < total)
+            return 0;
+
+        uint8_t *p = out;
+        *p++ = HC15_FRAME_SYNC;
+        *p++ = static_cast<uint8_t>(HC15_FRAME_HEADER_LEN + frame.len);
+        *p++ = frame.flags;
+        p = put16(p, frame.dst);
+        p = put16(p, frame.src);
+        *p++ = frame.type;
+        p = put16(p, frame.seq);
+        *p++ = frame.port;
+        memcpy(p, frame.payload, frame.len);
+        p += frame.len;
+        uint16_t crc = crc16(out + 1, p - out - 1);
+        p = put16(p, crc);
+        return p - out;
+    }
+
+    /*
+     * @brief Encode a frame with Reed-Solomon protection.
+     * @return The number of bytes written, or 0 if the frame does not fit.
+     */
+    static size_t encodeFec(const HC15Frame &frame, HC15_FEC_MODE mode, uint8_t *out, size_t cap)
+    {
+        uint8_t npar = static_cast<uint8_t>(mode);
+        if (npar == 0)
+            return encode(frame, out, cap);
+        if (!out || cap < static_cast<size_t>(HC15_FRAME_FEC_HEADER_LEN - 1 + HC15_FRAME_OVERHEAD + frame.len + npar))
+            return 0;
+
+        // 先按普通帧编码，SYNC 落在 out[4]，LEN .. CRC 从 out[5] 开始就是 RS 的数据块
+        size_t n = encode(frame, out + HC15_FRAME_FEC_HEADER_LEN - 1, cap - HC15_FRAME_FEC_HEADER_LEN - npar + 1);
+        if (n == 0)
+            return 0;
+        uint8_t len = out[HC15_FRAME_FEC_HEADER_LEN];
+        out[0] = HC15_FRAME_SYNC_FEC;
+        out[1] = fecModeCode(mode);
+        out[2] = out[3] = out[4] = len;
+
+        size_t k = n - 1;
+        HC15ReedSolomon::encode(out + HC15_FRAME_FEC_HEADER_LEN, k, out + HC15_FRAME_FEC_HEADER_LEN + k, npar);
+        return HC15_FRAME_FEC_HEADER_LEN + k + npar;
+    }
+
+    static uint8_t fecModeCode(HC15_FEC_MODE mode)
+    {
+        switch (mode)
+        {
+        case HC15_FEC_MODE::LIGHT:
+            return 0x07;
+        case HC15_FEC_MODE::MEDIUM:
+            return 0x38;
+        case HC15_FEC_MODE::STRONG:
+            return 0xC0;
+        default:
+            return 0x00;
+        }
+    }
+
+    /*
+     * @brief Map a received MODE byte to the nearest codeword (up to 2 bit errors).
+     * @return The parity length, or 0 if the byte is too far from every codeword.
+     */
+    static uint8_t fecParityFromCode(uint8_t code)
+    {
+        const HC15_FEC_MODE modes[] = {HC15_FEC_MODE::LIGHT, HC15_FEC_MODE::MEDIUM, HC15_FEC_MODE::STRONG};
+        for (HC15_FEC_MODE mode : modes)
+        {
+            uint8_t diff = code ^ fecModeCode(mode);
+            uint8_t bits = 0;
+            for (; diff; diff &= diff - 1)
+                bits++;
+            if (bits <= 2)
+                return static_cast<uint8_t>(mode);
+        }
+        return 0;
+    }
+
+    static uint8_t *put16(uint8_t *p, uint16_t v)
+    {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        return p + 2;
+    }
+
+    static uint16_t get16(const uint8_t *p)
+    {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+};
+
+/*
+ * Receive-side address filter, checked as soon as FLAGS + DST have arrived.
+ */
+struct HC15AddressFilter
+{
+    uint16_t node_id = HC15_BROADCAST_ID; // 未配置时全收
+    uint16_t groups[HC15_FRAME_MAX_GROUPS];
+    uint8_t group_count = 0;
+    bool promiscuous = false; // 中继 / 抓包时全收
+
+    bool accepts(uint8_t flags, uint16_t dst) const
+    {
+        return promiscuous || addressed(flags, dst);
+    }
+
+    /*
+     * @brief true if the frame is really meant for this node, ignoring promiscuous mode.
+     */
+    bool addressed(uint8_t flags, uint16_t dst) const
+    {
+        if ((flags & HC15_FLAG_BCAST) || node_id == HC15_BROADCAST_ID)
+            return true;
+        if (flags & HC15_FLAG_MCAST)
+        {
+            for (uint8_t i = 0; i < group_count; i++)
+            {
+                if (groups[i] == dst)
+                    return true;
+            }
+            return false;
+        }
+        return dst == node_id;
+    }
+
+    bool join(uint16_t group)
+    {
+        for (uint8_t i = 0; i < group_count; i++)
+        {
+            if (groups[i] == group)
+                return true;
+        }
+        if (group_count >= HC15_FRAME_MAX_GROUPS)
+            return false;
+        groups[group_count++] = group;
+        return true;
+    }
+
+    bool leave(uint16_t group)
+    {
+        for (uint8_t i = 0; i < group_count; i++)
+        {
+            if (groups[i] == group)
+            {
+                groups[i] = groups[--group_count];
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/*
+ * Byte-at-a-time frame parser, resynchronises on SYNC after any error.
+ * With a filter set, frames for other nodes are skipped byte by byte: no copy, no CRC, no unpack.
+ */
+class HC15FrameParser
+{
+public:
+    void setFilter(const HC15AddressFilter *filter) { filter_ = filter; }
+
+    /*
+     * @brief Feed one received byte.
+     * @return true when a complete, CRC-valid frame is available via frame().
+     */
+    bool feed(uint8_t c)
+    {
+        switch (state_)
+        {
+        case State::SYNC:
+            if (c == HC15_FRAME_SYNC)
+                state_ = State::LEN;
+            else if (c == HC15_FRAME_SYNC_FEC)
+                state_ = State::FEC_MODE;
+            return false;
+
+        case State::FEC_MODE:
+            fec_npar_ = HC15FrameCodec::fecParityFromCode(c);
+            pos_ = 0;
+            state_ = fec_npar_ ? State::FEC_LEN : State::SYNC;
+            return false;
+
+        case State::FEC_LEN:
+            fec_buf_[pos_++] = c;
+            if (pos_ < 3)
+                return false;
+            {
+                // 三取二，逐位多数表决
+                uint8_t len = (fec_buf_[0] & fec_buf_[1]) | (fec_buf_[0] & fec_buf_[2]) | (fec_buf_[1] & fec_buf_[2]);
+                if (len < HC15_FRAME_HEADER_LEN || len > HC15_FRAME_HEADER_LEN + HC15_FRAME_MAX_BODY)
+                {
+                    bad_frames_++;
+                    state_ = State::SYNC;
+                    return false;
+                }
+                fec_len_ = len + 3 + fec_npar_; // LEN + body + CRC16 + parity
+                pos_ = 0;
+                state_ = State::FEC_BLOCK;
+            }
+            return false;
+
+        case State::FEC_BLOCK:
+            fec_buf_[pos_++] = c;
+            if (pos_ < fec_len_)
+                return false;
+            return replayFec();
+
+        case State::LEN:
+            if (c < HC15_FRAME_HEADER_LEN || c > HC15_FRAME_HEADER_LEN + HC15_FRAME_MAX_BODY)
+            {
+                bad_frames_++;
+                state_ = State::SYNC;
+                return feed(c); // 这个字节可能就是下一帧的 SYNC
+            }
+            body_len_ = c;
+            pos_ = 0;
+            crc_ = HC15FrameCodec::crc16(&c, 1);
+            state_ = State::BODY;
+            return false;
+
+        case State::BODY:
+            body_[pos_++] = c;
+            if (pos_ == HC15_FRAME_ADDR_LEN && filter_ &&
+                !filter_->accepts(body_[0], HC15FrameCodec::get16(body_ + 1)))
+            {
+                skip_ = body_len_ - HC15_FRAME_ADDR_LEN + 2; // 剩余负载 + CRC
+                state_ = State::SKIP;
+                return false;
+            }
+            if (pos_ == body_len_)
+            {
+                crc_ = HC15FrameCodec::crc16(body_, body_len_, crc_);
+                pos_ = 0;
+                state_ = State::CRC;
+            }
+            return false;
+
+        case State::CRC:
+            crc_rx_[pos_++] = c;
+            if (pos_ < 2)
+                return false;
+            state_ = State::SYNC;
+            if (HC15FrameCodec::get16(crc_rx_) != crc_)
+            {
+                bad_frames_++;
+                return false;
+            }
+            unpack();
+            return true;
+
+        case State::SKIP:
+            if (--skip_ == 0)
+            {
+                filtered_frames_++;
+                state_ = State::SYNC;
+            }
+            return false;
+        }
+        return false;
+    }
+
+    const HC15Frame &frame() const { return frame_; }
+    HC15Frame &frame() { return frame_; }
+    uint32_t badFrames() const { return bad_frames_; }
+    uint32_t filteredFrames() const { return filtered_frames_; }
+    uint32_t fecCorrected() const { return fec_corrected_; }
+    uint32_t fecFailed() const { return fec_failed_; }
+
+    void reset() { state_ = State::SYNC; }
+
+    /*
+     * @brief true between frames, the next byte fed may start a new one.
+     */
+    bool idle() const { return state_ == State::SYNC; }
+
+private:
+    enum class State : uint8_t
+    {
+        SYNC,
+        LEN,
+        BODY,
+        CRC,
+        SKIP,
+        FEC_MODE,
+        FEC_LEN,
+        FEC_BLOCK,
+    };
+
+    /*
+     * @brief Repair the collected FEC block and run it through the plain states.
+     *        Address filtering happens here, after decoding, since the header may have been damaged.
+     */
+    bool replayFec()
+    {
+        state_ = State::SYNC;
+        int fixed = HC15ReedSolomon::decode(fec_buf_, fec_len_, fec_npar_);
+        if (fixed < 0)
+        {
+            fec_failed_++;
+            bad_frames_++;
+            return false;
+        }
+        fec_corrected_ += fixed;
+
+        bool done = feed(HC15_FRAME_SYNC);
+        for (uint16_t i = 0; i < fec_len_ - fec_npar_; i++)
+            done = feed(fec_buf_[i]);
+        return done;
+    }
+
+    void unpack()
+    {
+        frame_.flags = body_[0];
+        frame_.dst = HC15FrameCodec::get16(body_ + 1);
+        frame_.src = HC15FrameCodec::get16(body_ + 3);
+        frame_.type = body_[5];
+        frame_.seq = HC15FrameCodec::get16(body_ + 6);
+        frame_.port = body_[8];
+        frame_.len = body_len_ - HC15_FRAME_HEADER_LEN;
+        memcpy(frame_.payload, body_ + HC15_FRAME_HEADER_LEN, frame_.len);
+    }
+
+    State state_ = State::SYNC;
+    uint8_t body_len_ = 0;
+    uint8_t pos_ = 0;
+    uint16_t skip_ = 0;
+    uint16_t crc_ = 0;
+    uint8_t crc_rx_[2] = {0, 0};
+    uint8_t body_[HC15_FRAME_HEADER_LEN + HC15_FRAME_MAX_BODY];
+    HC15Frame frame_;
+    const HC15AddressFilter *filter_ = nullptr;
+    uint8_t fec_npar_ = 0;
+    uint16_t fec_len_ = 0;
+    uint8_t fec_buf_[255];
+    uint32_t bad_frames_ = 0;
+    uint32_t filtered_frames_ = 0;
+    uint32_t fec_corrected_ = 0;
+    uint32_t fec_failed_ = 0;
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <Arduino.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+
+/*
+ * Direct GPIO register access for the STA / KEY hot paths (ESP32-C3, GPIO0~21 in one register).
+ * digitalRead() / digitalWrite() go through the Arduino pin-mapping and HAL layers on every call;
+ * these are one load or one store with a mask computed up front. Pin direction / pull still has
+ * to be set once with pinMode().
+ */
+
+#ifndef HC15_FAST_GPIO
+#define HC15_FAST_GPIO 1 // 0 = 回退到 digitalRead / digitalWrite
+#endif
+
+/*
+ * @brief Pin chosen at run time, mask computed in the constructor.
+ */
+class HC15FastPin
+{
+public:
+    HC15FastPin() {}
+    explicit HC15FastPin(uint8_t pin) : pin_(pin), mask_(pin < 32 ? 1ul << pin : 0) {}
+
+    bool read() const
+    {
+#if HC15_FAST_GPIO
+        return (REG_READ(GPIO_IN_REG) & mask_) != 0;
+#else
+        return digitalRead(pin_) == HIGH;
+#endif
+    }
+
+    void high() const
+    {
+#if HC15_FAST_GPIO
+        REG_WRITE(GPIO_OUT_W1TS_REG, mask_);
+#else
+        digitalWrite(pin_, HIGH);
+#endif
+    }
+
+    void low() const
+    {
+#if HC15_FAST_GPIO
+        REG_WRITE(GPIO_OUT_W1TC_REG, mask_);
+#else
+        digitalWrite(pin_, LOW);
+#endif
+    }
+
+    uint8_t pin() const { return pin_; }
+
+private:
+    uint8_t pin_ = 0;
+    uint32_t mask_ = 0;
+};
+
+/*
+ * @brief Pin known at compile time: the mask is a constant folded into the instruction.
+ */
+template <uint8_t PIN>
+struct HC15StaticPin
+{
+    static_assert(PIN < 32, "ESP32-C3 GPIOs live in the first in/out register");
+    static const uint32_t MASK = 1ul << PIN;
+
+    static bool read() { return (REG_READ(GPIO_IN_REG) & MASK) != 0; }
+    static void high() { REG_WRITE(GPIO_OUT_W1TS_REG, MASK); }
+    static void low() { REG_WRITE(GPIO_OUT_W1TC_REG, MASK); }
+};
+
+/*
+ * Cycles per STA read / KEY write for the Arduino calls and the register paths, measured with the
+ * CPU cycle counter. KEY is only ever written HIGH (its idle level), so the module stays in
+ * transparent mode while this runs.
+ */
+template <uint8_t STA_PIN, uint8_t KEY_PIN>
+class HC15GpioBench
+{
+public:
+    struct Result
+    {
+        uint32_t arduino_read;
+        uint32_t fast_read;
+        uint32_t static_read;
+        uint32_t arduino_write;
+        uint32_t fast_write;
+        uint32_t static_write;
+    };
+
+    static Result run(uint32_t iterations = 10000)
+    {
+        Result r;
+        HC15FastPin sta(STA_PIN), key(KEY_PIN);
+        volatile bool sink = false; // 防止读被优化掉
+        uint32_t n = iterations ? iterations : 1;
+        uint32_t base = measure(n, [&]() {}); // 空循环本身的开销
+
+        r.arduino_read = (measure(n, [&]() { sink = digitalRead(STA_PIN) == LOW; }) - base) / n;
+        r.fast_read = (measure(n, [&]() { sink = !sta.read(); }) - base) / n;
+        r.static_read = (measure(n, [&]() { sink = !HC15StaticPin<STA_PIN>::read(); }) - base) / n;
+        r.arduino_write = (measure(n, [&]() { digitalWrite(KEY_PIN, HIGH); }) - base) / n;
+        r.fast_write = (measure(n, [&]() { key.high(); }) - base) / n;
+        r.static_write = (measure(n, [&]() { HC15StaticPin<KEY_PIN>::high(); }) - base) / n;
+        (void)sink;
+        return r;
+    }
+
+    static void print(Stream *out, const Result &r)
+    {
+        out->printf("STA read  cycles/call: digitalRead %lu, fast %lu, static %lu\n",
+                    static_cast<unsigned long>(r.arduino_read), static_cast<unsigned long>(r.fast_read),
+                    static_cast<unsigned long>(r.static_read));
+        out->printf("KEY write cycles/call: digitalWrite %lu, fast %lu, static %lu\n",
+                    static_cast<unsigned long>(r.arduino_write), static_cast<unsigned long>(r.fast_write),
+                    static_cast<unsigned long>(r.static_write));
+    }
+
+private:
+    template <typename F>
+    static uint32_t measure(uint32_t n, F fn)
+    {
+        uint32_t start = ESP.getCycleCount();
+        for (uint32_t i = 0; i < n; i++)
+        {
+            fn();
+            __asm__ __volatile__("" ::: "memory"); // 不让循环被合并
+        }
+        return ESP.getCycleCount() - start;
+    }
+};
@@ -0,0 +1,399 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <lora_frame.hpp>
+
+/*
+ * Binary upstream format between the gateway and the host, replacing the ASCII line dump.
+ *
+ * record:
+ *   SYNC(1) | KIND(1) | LEN(1) | BODY(LEN) | CRC16(2)
+ * CRC16 (CCITT, same as the air frames) covers KIND .. BODY, multi-byte fields are little endian.
+ * A host that joins mid-stream or sees a bad CRC hunts for the next SYNC and carries on.
+ *
+ *   FRAME: TS_US(8) | FLAGS(1) | DST(2) | SRC(2) | TYPE(1) | SEQ(2) | PORT(1) | PAYLOAD
+ *          the air frame header in wire order, SRC is the node ID; TS_US is the capture time of the
+ *          frame's last byte at the gateway (HC15Frame::rx_last_us)
+ *   STATS: TS_US(8) | GATEWAY(2) | counter(4) x HC15_HOST_STATS_COUNTERS, see HC15HostStats
+ *
+ * The codec and HC15HostDecoder only need the C library, so the same header builds on the host
+ * (g++ -I lib/lora) as the reference decoder; the gateway side (HC15HostUplink) is ARDUINO only.
+ */
+
+#define HC15_HOST_SYNC 0xA5
+#define HC15_HOST_HEADER_LEN 3 // SYNC + KIND + LEN
+#define HC15_HOST_TS_LEN 8
+#define HC15_HOST_FRAME_BODY (HC15_HOST_TS_LEN + HC15_FRAME_HEADER_LEN)
+#define HC15_HOST_STATS_COUNTERS 8
+#define HC15_HOST_STATS_BODY (HC15_HOST_TS_LEN + 2 + 4 * HC15_HOST_STATS_COUNTERS)
+#define HC15_HOST_MAX_BODY (HC15_HOST_FRAME_BODY + HC15_FRAME_MAX_BODY)
+#define HC15_HOST_MAX_RECORD (HC15_HOST_HEADER_LEN + HC15_HOST_MAX_BODY + 2)
+
+static_assert(HC15_HOST_MAX_BODY <= 255, "record body must fit LEN");
+static_assert(HC15_HOST_STATS_BODY <= HC15_HOST_MAX_BODY, "stats record larger than a frame record");
+
+enum class HC15_HOST_KIND : uint8_t
+{
+    FRAME = 1,
+    STATS = 2,
+};
+
+/*
+ * Link counters as reported upstream, in record order.
+ */
+struct HC15HostStats
+{
+    uint32_t received;     // 转发给主机的帧数
+    uint32_t dropped;      // 接收队列满丢弃
+    uint32_t bad;          // CRC / 长度错误
+    uint32_t filtered;     // 地址过滤
+    uint32_t duplicates;   // 去重 / 重放
+    uint32_t rejected;     // 认证失败
+    uint32_t fec_corrected;
+    uint32_t fec_failed;
+};
+
+class HC15HostCodec
+{
+public:
+    /*
+     * @brief Encode a received frame as a FRAME record.
+     * @return The number of bytes written, or 0 if it does not fit in cap.
+     */
+    static size_t encodeFrame(uint64_t ts_us, const HC15Frame &frame, uint8_t *out, size_t cap)
+    {
+        if (frame.len > HC15_FRAME_MAX_BODY || cap < HC15_HOST_HEADER_LEN + HC15_HOST_FRAME_BODY + frame.len + 2u)
+            return 0;
+        uint8_t *p = begin(out, HC15_HOST_KIND::FRAME, HC15_HOST_FRAME_BODY + frame.len);
+        p = put64(p, ts_us);
+        *p++ = frame.flags;
+        p = HC15FrameCodec::put16(p, frame.dst);
+        p = HC15FrameCodec::put16(p, frame.src);
+        *p++ = frame.type;
+        p = HC15FrameCodec::put16(p, frame.seq);
+        *p++ = frame.port;
+        memcpy(p, frame.payload, frame.len);
+        return end(out, p + frame.len);
+    }
+
+    /*
+     * @brief Encode a STATS record.
+     * @return The number of bytes written, or 0 if it does not fit in cap.
+     */
+    static size_t encodeStats(uint64_t ts_us, uint16_t gateway, const HC15HostStats &stats, uint8_t *out, size_t cap)
+    {
+        if (cap < HC15_HOST_HEADER_LEN + HC15_HOST_STATS_BODY + 2u)
+            return 0;
+        uint8_t *p = begin(out, HC15_HOST_KIND::STATS, HC15_HOST_STATS_BODY);
+        p = put64(p, ts_us);
+        p = HC15FrameCodec::put16(p, gateway);
+        const uint32_t counters[HC15_HOST_STATS_COUNTERS] = {stats.received, stats.dropped, stats.bad, stats.filtered,
+                                                             stats.duplicates, stats.rejected, stats.fec_corrected, stats.fec_failed};
+        for (uint8_t i = 0; i < HC15_HOST_STATS_COUNTERS; i++)
+            p = put32(p, counters[i]);
+        return end(out, p);
+    }
+
+    static bool decodeFrame(const uint8_t *body, size_t len, uint64_t &ts_us, HC15Frame &frame)
+    {
+        if (len < HC15_HOST_FRAME_BODY || len - HC15_HOST_FRAME_BODY > HC15_FRAME_MAX_BODY)
+            return false;
+        ts_us = get64(body);
+        const uint8_t *p = body + HC15_HOST_TS_LEN;
+        frame.flags = p[0];
+        frame.dst = HC15FrameCodec::get16(p + 1);
+        frame.src = HC15FrameCodec::get16(p + 3);
+        frame.type = p[5];
+        frame.seq = HC15FrameCodec::get16(p + 6);
+        frame.port = p[8];
+        frame.len = static_cast<uint8_t>(len - HC15_HOST_FRAME_BODY);
+        memcpy(frame.payload, p + HC15_FRAME_HEADER_LEN, frame.len);
+        frame.rx_first_us = frame.rx_last_us = static_cast<int64_t>(ts_us);
+        return true;
+    }
+
+    static bool decodeStats(const uint8_t *body, size_t len, uint64_t &ts_us, uint16_t &gateway, HC15HostStats &stats)
+    {
+        if (len < HC15_HOST_STATS_BODY)
+            return false; // 以后追加的计数器放在末尾，旧主机忽略
+        ts_us = get64(body);
+        gateway = HC15FrameCodec::get16(body + HC15_HOST_TS_LEN);
+        const uint8_t *p = body + HC15_HOST_TS_LEN + 2;
+        uint32_t *counters[HC15_HOST_STATS_COUNTERS] = {&stats.received, &stats.dropped, &stats.bad, &stats.filtered,
+                                                        &stats.duplicates, &stats.rejected, &stats.fec_corrected, &stats.fec_failed};
+        for (uint8_t i = 0; i < HC15_HOST_STATS_COUNTERS; i++, p += 4)
+            *counters[i] = get32(p);
+        return true;
+    }
+
+    static uint8_t *put32(uint8_t *p, uint32_t v)
+    {
+        for (uint8_t i = 0; i < 4; i++)
+            *p++ = static_cast<uint8_t>(v >> (8 * i));
+        return p;
+    }
+
+    static uint8_t *put64(uint8_t *p, uint64_t v)
+    {
+        for (uint8_t i = 0; i < 8; i++)
+            *p++ = static_cast<uint8_t>(v >> (8 * i));
+        return p;
+    }
+
+    static uint32_t get32(const uint8_t *p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+               (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static uint64_t get64(const uint8_t *p)
+    {
+        return static_cast<uint64_t>(get32(p)) | (static_cast<uint64_t>(get32(p + 4)) << 32);
+    }
+
+private:
+    static uint8_t *begin(uint8_t *out, HC15_HOST_KIND kind, size_t len)
+    {
+        out[0] = HC15_HOST_SYNC;
+        out[1] = static_cast<uint8_t>(kind);
+        out[2] = static_cast<uint8_t>(len);
+        return out + HC15_HOST_HEADER_LEN;
+    }
+
+    static size_t end(uint8_t *out, uint8_t *p)
+    {
+        uint16_t crc = HC15FrameCodec::crc16(out + 1, p - out - 1);
+        p = HC15FrameCodec::put16(p, crc);
+        return p - out;
+    }
+};
+
+typedef void (*HC15HostFrameCallback)(uint64_t ts_us, const HC15Frame &frame, void *ctx);
+typedef void (*HC15HostStatsCallback)(uint64_t ts_us, uint16_t gateway, const HC15HostStats &stats, void *ctx);
+
+/*
+ * Incremental record decoder, feed it whatever read() returned. No allocation, bodies are copied
+ * with memcpy straight out of the input, so one core keeps up with many gateways at full USB rate.
+ */
+class HC15HostDecoder
+{
+public:
+    void setFrameCallback(HC15HostFrameCallback cb, void *ctx = nullptr)
+    {
+        frame_cb_ = cb;
+        frame_ctx_ = ctx;
+    }
+
+    void setStatsCallback(HC15HostStatsCallback cb, void *ctx = nullptr)
+    {
+        stats_cb_ = cb;
+        stats_ctx_ = ctx;
+    }
+
+    /*
+     * @return The number of complete records decoded from this chunk.
+     */
+    size_t feed(const uint8_t *data, size_t len)
+    {
+        size_t records = 0;
+        const uint8_t *end = data + len;
+        while (data < end)
+        {
+            if (!in_record_)
+            {
+                const uint8_t *sync = static_cast<const uint8_t *>(memchr(data, HC15_HOST_SYNC, end - data));
+                skipped_ += (sync ? sync : end) - data;
+                if (!sync)
+                    break;
+                data = sync + 1;
+                in_record_ = true;
+                have_ = 0;
+                continue;
+            }
+            size_t n = (have_ < 2 ? 2 : recordLen()) - have_;
+            if (n > static_cast<size_t>(end - data))
+                n = end - data;
+            memcpy(buf_ + have_, data, n);
+            have_ += n;
+            data += n;
+            records += drain();
+        }
+        return records;
+    }
+
+    uint32_t records() const { return records_; }
+    uint32_t badRecords() const { return bad_; }
+    uint32_t skippedBytes() const { return skipped_; }
+
+private:
+    /*
+     * @brief KIND + LEN + BODY + CRC, valid once the first two bytes are in.
+     */
+    size_t recordLen() const { return 2 + static_cast<size_t>(buf_[1]) + 2; }
+
+    /*
+     * @brief Decode the buffered record if complete. After a bad CRC the SYNC may have been a data
+     *        byte, so look for the next SYNC inside what is already buffered instead of dropping it.
+     */
+    size_t drain()
+    {
+        size_t records = 0;
+        while (in_record_ && have_ >= 2 && have_ >= recordLen())
+        {
+            size_t used = recordLen();
+            if (dispatch())
+            {
+                records++;
+                in_record_ = false;
+                break;
+            }
+            const uint8_t *sync = static_cast<const uint8_t *>(memchr(buf_, HC15_HOST_SYNC, used));
+            if (!sync)
+            {
+                skipped_ += used;
+                in_record_ = false;
+                break;
+            }
+            size_t skip = sync - buf_ + 1;
+            skipped_ += skip;
+            memmove(buf_, buf_ + skip, have_ - skip);
+            have_ -= skip;
+        }
+        return records;
+    }
+
+    bool dispatch()
+    {
+        const uint8_t *body = buf_ + 2;
+        size_t len = buf_[1];
+        uint8_t kind = buf_[0];
+        if (HC15FrameCodec::crc16(buf_, 2 + len) != HC15FrameCodec::get16(body + len))
+        {
+            bad_++;
+            return false;
+        }
+        uint64_t ts;
+        if (kind == static_cast<uint8_t>(HC15_HOST_KIND::FRAME))
+        {
+            if (!HC15HostCodec::decodeFrame(body, len, ts, frame_))
+            {
+                bad_++;
+                return false;
+            }
+            if (frame_cb_)
+                frame_cb_(ts, frame_, frame_ctx_);
+        }
+        else if (kind == static_cast<uint8_t>(HC15_HOST_KIND::STATS))
+        {
+            uint16_t gateway;
+            HC15HostStats stats;
+            if (!HC15HostCodec::decodeStats(body, len, ts, gateway, stats))
+            {
+                bad_++;
+                return false;
+            }
+            if (stats_cb_)
+                stats_cb_(ts, gateway, stats, stats_ctx_);
+        }
+        records_++; // 未知类型也算，新固件可以加记录类型
+        return true;
+    }
+
+    bool in_record_ = false;
+    size_t have_ = 0;
+    uint8_t buf_[2 + 255 + 2]; // SYNC 之后的 KIND .. CRC
+    HC15Frame frame_;
+    HC15HostFrameCallback frame_cb_ = nullptr;
+    void *frame_ctx_ = nullptr;
+    HC15HostStatsCallback stats_cb_ = nullptr;
+    void *stats_ctx_ = nullptr;
+    uint32_t records_ = 0;
+    uint32_t bad_ = 0;
+    uint32_t skipped_ = 0;
+};
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <lora_link.hpp>
+
+#ifndef HC15_HOST_STATS_MS
+#define HC15_HOST_STATS_MS 10000 // 链路统计上报周期
+#endif
+
+#ifndef HC15_HOST_BATCH
+#define HC15_HOST_BATCH 512 // 一次 USB 写入的记录缓冲
+#endif
+
+static_assert(HC15_HOST_BATCH >= HC15_HOST_MAX_RECORD, "batch buffer must hold one record");
+
+/*
+ * Gateway side: drains the link's default queue and writes FRAME records to the host port, batched
+ * into one write per burst, plus a STATS record every HC15_HOST_STATS_MS.
+ */
+class HC15HostUplink
+{
+public:
+    HC15HostUplink(HC15Link *link, Stream *out) : link_(link), out_(out) {}
+
+    /*
+     * @brief use rtos task please.
+     */
+    void uplinkTask(void * /*pvParameters*/)
+    {
+        HC15Frame frame;
+        uint32_t stats_ms = millis();
+        for (;;)
+        {
+            // 队列空了才写出，突发时多条记录合成一次 USB 传输
+            uint32_t wait = fill_ ? 0 : 100;
+            if (link_->receive(frame, wait))
+            {
+                if (fill_ + HC15_HOST_MAX_RECORD > sizeof(batch_))
+                    flush();
+                uint64_t ts = frame.rx_last_us ? frame.rx_last_us : esp_timer_get_time();
+                fill_ += HC15HostCodec::encodeFrame(ts, frame, batch_ + fill_, sizeof(batch_) - fill_);
+                received_++;
+                continue;
+            }
+            if (millis() - stats_ms >= HC15_HOST_STATS_MS)
+            {
+                stats_ms = millis();
+                if (fill_ + HC15_HOST_MAX_RECORD > sizeof(batch_))
+                    flush();
+                fill_ += HC15HostCodec::encodeStats(esp_timer_get_time(), link_->nodeId(), stats(), batch_ + fill_, sizeof(batch_) - fill_);
+            }
+            flush();
+        }
+    }
+
+    HC15HostStats stats() const
+    {
+        HC15HostStats s;
+        s.received = received_;
+        s.dropped = link_->droppedFrames();
+        s.bad = link_->badFrames();
+        s.filtered = link_->filteredFrames();
+        s.duplicates = link_->duplicateFrames();
+        s.rejected = link_->rejectedFrames();
+        s.fec_corrected = link_->fecCorrected();
+        s.fec_failed = link_->fecFailed();
+        return s;
+    }
+
+private:
+    void flush()
+    {
+        if (fill_)
+            out_->write(batch_, fill_);
+        fill_ = 0;
+    }
+
+    HC15Link *link_ = nullptr;
+    Stream *out_ = nullptr;
+    uint8_t batch_[HC15_HOST_BATCH];
+    size_t fill_ = 0;
+    uint32_t received_ = 0;
+};
+#endif
@@ -0,0 +1,605 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_class.hpp>
+#include <lora_frame.hpp>
+#include <lora_peers.hpp>
+#include <lora_auth.hpp>
+#include <lora_blob.hpp>
+#include <Preferences.h>
+
+#ifndef HC15_LINK_RX_DEPTH
+#define HC15_LINK_RX_DEPTH 8 // 收帧队列深度
+#endif
+
+#ifndef HC15_LINK_MAX_HANDLERS
+#define HC15_LINK_MAX_HANDLERS 8
+#endif
+
+#ifndef HC15_LINK_MAX_PORTS
+#define HC15_LINK_MAX_PORTS 4 // 可单独开队列的逻辑端口数
+#endif
+
+#define HC15_PORT_DEFAULT 0 // 未开端口的 DATA 帧都进默认队列
+
+/*
+ * @brief Per-type frame hook, runs in the monitorTask context.
+ * @return true if the frame was consumed and must not reach the receive queue.
+ */
+typedef bool (*HC15FrameHandler)(const HC15Frame &frame, void *ctx);
+
+/*
+ * Frame-level endpoint on top of an HC15: addressing, sequence numbers and dispatch.
+ * begin() switches the HC15 into binary mode, so readLine() is no longer fed.
+ */
+class HC15Link
+{
+public:
+    HC15Link(HC15 *hc15, uint16_t node_id) : hc15_(hc15), node_id_(node_id)
+    {
+        rx_queue_ = xQueueCreate(HC15_LINK_RX_DEPTH, sizeof(HC15Frame));
+        peers_lock_ = xSemaphoreCreateMutex();
+        filter_.node_id = node_id;
+        parser_.setFilter(&filter_);
+    }
+
+    bool begin()
+    {
+        if (!hc15_ || !rx_queue_ || !peers_lock_)
+            return false;
+        hc15_->setRxCallback(&HC15Link::onRxBytes, this);
+        return true;
+    }
+
+    uint16_t nodeId() const { return node_id_; }
+    HC15 *driver() { return hc15_; }
+
+    /*
+     * @brief Accept multicast frames addressed to a group.
+     * @return false if HC15_FRAME_MAX_GROUPS groups are already joined.
+     */
+    bool joinGroup(uint16_t group) { return filter_.join(group); }
+    bool leaveGroup(uint16_t group) { return filter_.leave(group); }
+
+    /*
+     * @brief Accept every frame regardless of destination (relays, sniffers).
+     *        Only frames addressed to this node still reach handlers and the receive queue.
+     */
+    void setPromiscuous(bool on) { filter_.promiscuous = on; }
+
+    /*
+     * @brief Mark every frame this node originates as relayable with the given hop limit.
+     * @param hops 0 disables flooding, at most 7.
+     */
+    void setHopLimit(uint8_t hops) { hop_limit_ = hops > 7 ? 7 : hops; }
+
+    /*
+     * @brief Protect outgoing frames with Reed-Solomon parity (receivers decode either format).
+     */
+    void setFec(HC15_FEC_MODE mode) { fec_ = mode; }
+    HC15_FEC_MODE fec() const { return fec_; }
+
+    /*
+     * @brief Encrypt every outgoing payload (in place, AES-CTR) and decrypt HC15_FLAG_ENC frames.
+     * @param cipher Keyed cipher shared by the network, nullptr switches encryption off.
+     * @param require Drop received frames that are not encrypted.
+     */
+    void setCipher(HC15Cipher *cipher, bool require = true)
+    {
+        if (!mac_)
+        {
+            uint32_t epoch = esp_random(); // 重启后 seq 从 0 开始，epoch 保证 nonce 不重复
+            portENTER_CRITICAL(&tx_seq_mux_);
+            epoch_ = epoch;
+            portEXIT_CRITICAL(&tx_seq_mux_);
+        }
+        require_enc_ = cipher && require;
+        cipher_ = cipher;
+    }
+
+    /*
+     * @brief Tag every outgoing frame with a truncated CMAC and check tags plus a per-peer replay
+     *        window on receive.
+     * @param epoch Frame counter base, must be larger than on any previous boot (HC15BootEpoch::next()).
+     * @param require Drop received frames without a tag.
+     */
+    void setAuth(HC15Cmac *mac, uint32_t epoch, bool require = true)
+    {
+        portENTER_CRITICAL(&tx_seq_mux_);
+        epoch_ = epoch;
+        portEXIT_CRITICAL(&tx_seq_mux_);
+        require_mac_ = mac && require;
+        mac_ = mac;
+    }
+
+    /*
+     * @brief Worst-case wire bytes added around a payload with the current settings.
+     */
+    size_t wireOverhead() const
+    {
+        return HC15_FRAME_OVERHEAD + (cipher_ || mac_ ? HC15_CRYPTO_EPOCH_LEN : 0) + (mac_ ? HC15_MAC_TAG_LEN : 0) +
+               (fec_ == HC15_FEC_MODE::OFF ? 0 : HC15_FRAME_FEC_HEADER_LEN - 1 + static_cast<uint8_t>(fec_));
+    }
+
+    /*
+     * @brief Hook that sees every frame the parser accepts, before local dispatch (see HC15Relay).
+     *        Returning true drops the frame (e.g. duplicate).
+     */
+    void setForwardHook(HC15FrameHandler hook, void *ctx)
+    {
+        forward_ctx_ = ctx;
+        forward_hook_ = hook;
+    }
+
+    /*
+     * @brief Drop frames whose (src, seq) was already delivered (retransmissions, relayed copies). On by default.
+     */
+    void setDuplicateFilter(bool on) { dedup_ = on; }
+
+    /*
+     * @brief Run fn(table, slot) for every known peer with the peer table locked (housekeeping, stats dumps).
+     */
+    template <typename Fn>
+    void forEachPeer(Fn fn)
+    {
+        xSemaphoreTake(peers_lock_, portMAX_DELAY);
+        peers_.forEach([&](uint16_t slot)
+                       { fn(peers_, slot); });
+        xSemaphoreGive(peers_lock_);
+    }
+
+    /*
+     * @brief When a node was last heard from (millis()).
+     * @return false if the node is not in the peer table.
+     */
+    bool lastHeard(uint16_t id, uint32_t &ms)
+    {
+        xSemaphoreTake(peers_lock_, portMAX_DELAY);
+        uint16_t slot = peers_.find(id);
+        if (slot != HC15PeerTable<>::NONE)
+            ms = peers_.lastSeen(slot);
+        xSemaphoreGive(peers_lock_);
+        return slot != HC15PeerTable<>::NONE;
+    }
+
+    /*
+     * @brief Forget peers not heard from for max_age_ms.
+     * @return The number of peers removed.
+     */
+    uint16_t expirePeers(uint32_t max_age_ms)
+    {
+        xSemaphoreTake(peers_lock_, portMAX_DELAY);
+        uint16_t removed = peers_.expire(millis(), max_age_ms);
+        xSemaphoreGive(peers_lock_);
+        return removed;
+    }
+
+    /*
+     * @brief Save the per-peer replay floors (last accepted authenticated (epoch, seq)) to NVS.
+     *        Frames accepted after the last save can be replayed once after an unplanned reboot,
+     *        so save as often as the flash budget allows (replayFloorTask()) and before restarts.
+     */
+    bool saveReplayFloors()
+    {
+        Preferences prefs;
+        if (!prefs.begin("hc15", false))
+            return false;
+        xSemaphoreTake(peers_lock_, portMAX_DELAY);
+        peers_.syncFloors();
+        const HC15PeerTable<>::Floors &floors = peers_.floors();
+        bool ok = prefs.putBytes("floors", &floors, sizeof(floors)) == sizeof(floors); // NVS 写几毫秒，UART 缓冲兜得住
+        xSemaphoreGive(peers_lock_);
+        prefs.end();
+        return ok;
+    }
+
+    /*
+     * @brief Restore the replay floors saved before a reboot, call before begin().
+     * @return false if nothing (or a table of another size) was saved.
+     */
+    bool loadReplayFloors()
+    {
+        Preferences prefs;
+        if (!prefs.begin("hc15", true))
+            return false;
+        bool ok = prefs.getBytesLength("floors") == sizeof(HC15PeerTable<>::Floors);
+        if (ok)
+        {
+            xSemaphoreTake(peers_lock_, portMAX_DELAY);
+            ok = prefs.getBytes("floors", &peers_.floors(), sizeof(HC15PeerTable<>::Floors)) == sizeof(HC15PeerTable<>::Floors);
+            if (!ok)
+                peers_.clearFloors();
+            xSemaphoreGive(peers_lock_);
+        }
+        prefs.end();
+        return ok;
+    }
+
+    /*
+     * @brief Save the replay floors periodically, use rtos task please.
+     * @param pvParameters Save interval in ms (uintptr_t), 0 = 10 minutes.
+     */
+    void replayFloorTask(void *pvParameters)
+    {
+        uint32_t interval_ms = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pvParameters));
+        if (interval_ms == 0)
+            interval_ms = 600000;
+        for (;;)
+        {
+            vTaskDelay(pdMS_TO_TICKS(interval_ms));
+            if (mac_)
+                saveReplayFloors();
+        }
+    }
+
+    /*
+     * @brief Give a logical port its own receive queue and/or callback so one chatty service
+     *        cannot head-of-line block the others.
+     * @param port The port number (HC15_PORT_DEFAULT is the shared default queue).
+     * @param depth Queue depth for this port, 0 = callback only.
+     * @param cb Optional callback, runs in the monitorTask context; returning true consumes the frame.
+     * @return false if the port is already open or the port table is full.
+     */
+    bool openPort(uint8_t port, uint8_t depth, HC15FrameHandler cb = nullptr, void *ctx = nullptr)
+    {
+        if (port == HC15_PORT_DEFAULT || findPort(port) || port_count_ >= HC15_LINK_MAX_PORTS || (!depth && !cb))
+            return false;
+        Port &p = ports_[port_count_];
+        p.queue = depth ? xQueueCreate(depth, sizeof(HC15Frame)) : nullptr;
+        if (depth && !p.queue)
+            return false;
+        p.port = port;
+        p.cb = cb;
+        p.ctx = ctx;
+        p.dropped = 0;
+        port_count_++;
+        return true;
+    }
+
+    /*
+     * @brief Register a handler for a frame type. Several handlers per type are called in
+     *        registration order until one consumes the frame.
+     * @return false if the handler table is full.
+     */
+    bool addHandler(HC15_FRAME_TYPE type, HC15FrameHandler handler, void *ctx)
+    {
+        if (!handler || handler_count_ >= HC15_LINK_MAX_HANDLERS)
+            return false;
+        handlers_[handler_count_++] = {static_cast<uint8_t>(type), handler, ctx};
+        return true;
+    }
+
+    /*
+     * @brief Fill in source / sequence number and encode the frame.
+     *        With a cipher set the payload is encrypted in place, so the frame must not be sent twice.
+     * @return The number of wire bytes written to out, or 0 if it does not fit.
+     */
+    size_t encode(HC15Frame &frame, uint8_t *out, size_t cap)
+    {
+        frame.src = node_id_;
+        uint32_t epoch;
+        portENTER_CRITICAL(&tx_seq_mux_); // 多个服务任务并发发送，(epoch, seq) 必须一次分配
+        frame.seq = tx_seq_++;
+        epoch = tx_seq_ ? epoch_ : epoch_++; // seq 回绕时换 epoch
+        portEXIT_CRITICAL(&tx_seq_mux_);
+        if (hop_limit_)
+            frame.flags = (frame.flags & ~HC15_FLAG_HOPS_MASK) | HC15_FLAG_RELAY | (hop_limit_ << HC15_FLAG_HOPS_SHIFT);
+        if ((cipher_ || mac_) && !seal(frame, epoch))
+            return 0;
+        return encodeRaw(frame, out, cap);
+    }
+
+    /*
+     * @brief Encode a frame as is (src / seq untouched, e.g. when relaying) with the link's FEC mode.
+     */
+    size_t encodeRaw(const HC15Frame &frame, uint8_t *out, size_t cap) const
+    {
+        return HC15FrameCodec::encodeFec(frame, fec_, out, cap);
+    }
+
+    /*
+     * @brief Send one frame, src and seq are filled in by the link.
+     */
+    bool sendFrame(HC15Frame &frame, uint32_t timeout_ms = 0)
+    {
+        uint8_t wire[HC15_FRAME_MAX_WIRE];
+        size_t n = encode(frame, wire, sizeof(wire));
+        if (n == 0)
+            return false;
+        return hc15_->send(wire, n, timeout_ms) == static_cast<int>(n);
+    }
+
+    /*
+     * @brief Send a payload to a node.
+     * @param dst The destination node ID, HC15_BROADCAST_ID for everyone.
+     */
+    bool send(uint16_t dst, HC15_FRAME_TYPE type, const uint8_t *payload, uint8_t len, uint32_t timeout_ms = 0)
+    {
+        return sendTo(dst, dst == HC15_BROADCAST_ID ? HC15_FLAG_BCAST : 0, type, payload, len, timeout_ms);
+    }
+
+    /*
+     * @brief Send a payload to every member of a multicast group.
+     */
+    bool sendMulticast(uint16_t group, HC15_FRAME_TYPE type, const uint8_t *payload, uint8_t len, uint32_t timeout_ms = 0)
+    {
+        return sendTo(group, HC15_FLAG_MCAST, type, payload, len, timeout_ms);
+    }
+
+    /*
+     * @brief Send application data to a logical port on a node.
+     */
+    bool sendPort(uint16_t dst, uint8_t port, const uint8_t *payload, uint8_t len, uint32_t timeout_ms = 0)
+    {
+        return sendTo(dst, dst == HC15_BROADCAST_ID ? HC15_FLAG_BCAST : 0, HC15_FRAME_TYPE::DATA, payload, len, timeout_ms, port);
+    }
+
+    /*
+     * @brief Take the next received frame that no handler consumed.
+     * @param timeout_ms How long to wait, 0 = do not block.
+     */
+    bool receive(HC15Frame &frame, uint32_t timeout_ms = 0)
+    {
+        return xQueueReceive(rx_queue_, &frame, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    }
+
+    /*
+     * @brief Take the next DATA frame received on an opened port.
+     */
+    bool receive(uint8_t port, HC15Frame &frame, uint32_t timeout_ms = 0)
+    {
+        Port *p = findPort(port);
+        if (!p)
+            return port == HC15_PORT_DEFAULT && receive(frame, timeout_ms);
+        return p->queue && xQueueReceive(p->queue, &frame, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    }
+
+    int available()
+    {
+        return uxQueueMessagesWaiting(rx_queue_);
+    }
+
+    int available(uint8_t port)
+    {
+        Port *p = findPort(port);
+        if (!p)
+            return port == HC15_PORT_DEFAULT ? available() : 0;
+        return p->queue ? uxQueueMessagesWaiting(p->queue) : 0;
+    }
+
+    /*
+     * @brief Free slots in a port's receive queue (the default queue for HC15_PORT_DEFAULT / unopened ports).
+     */
+    int space(uint8_t port = HC15_PORT_DEFAULT)
+    {
+        Port *p = findPort(port);
+        if (!p)
+            return uxQueueSpacesAvailable(rx_queue_);
+        return p->queue ? uxQueueSpacesAvailable(p->queue) : 0;
+    }
+
+    uint32_t droppedFrames(uint8_t port)
+    {
+        Port *p = findPort(port);
+        return p ? p->dropped : 0;
+    }
+
+    uint32_t droppedFrames() const { return rx_dropped_; }
+    uint32_t badFrames() const { return parser_.badFrames(); }
+    uint32_t filteredFrames() const { return parser_.filteredFrames(); }
+    uint32_t duplicateFrames() const { return rx_duplicates_; }
+    uint32_t fecCorrected() const { return parser_.fecCorrected(); }
+    uint32_t fecFailed() const { return parser_.fecFailed(); }
+    uint32_t rejectedFrames() const { return rx_rejected_; }
+
+private:
+    struct Handler
+    {
+        uint8_t type;
+        HC15FrameHandler fn;
+        void *ctx;
+    };
+
+    struct Port
+    {
+        uint8_t port;
+        QueueHandle_t queue;
+        HC15FrameHandler cb;
+        void *ctx;
+        uint32_t dropped;
+    };
+
+    Port *findPort(uint8_t port)
+    {
+        for (uint8_t i = 0; i < port_count_; i++)
+        {
+            if (ports_[i].port == port)
+                return &ports_[i];
+        }
+        return nullptr;
+    }
+
+    bool sendTo(uint16_t dst, uint8_t flags, HC15_FRAME_TYPE type, const uint8_t *payload, uint8_t len, uint32_t timeout_ms,
+                uint8_t port = HC15_PORT_DEFAULT)
+    {
+        if (len > HC15_FRAME_MAX_PAYLOAD || (len && !payload))
+            return false;
+        HC15Frame frame;
+        frame.flags = flags;
+        frame.type = static_cast<uint8_t>(type);
+        frame.dst = dst;
+        frame.port = port;
+        frame.len = len;
+        if (len)
+            memcpy(frame.payload, payload, len);
+        return sendFrame(frame, timeout_ms);
+    }
+
+    bool seal(HC15Frame &frame, uint32_t epoch)
+    {
+        if (frame.len > HC15_FRAME_MAX_PAYLOAD || frame.flags & (HC15_FLAG_ENC | HC15_FLAG_MAC))
+            return false;
+        if (cipher_)
+        {
+            if (!cipher_->ctr(frame.src, epoch, frame.seq, frame.payload, frame.len))
+                return false;
+            frame.flags |= HC15_FLAG_ENC;
+        }
+        for (uint8_t i = 0; i < HC15_CRYPTO_EPOCH_LEN; i++)
+            frame.payload[frame.len++] = static_cast<uint8_t>(epoch >> (8 * i));
+        if (mac_)
+        {
+            frame.flags |= HC15_FLAG_MAC;
+            uint8_t tag[16];
+            if (!tagFrame(frame, tag))
+                return false;
+            memcpy(frame.payload + frame.len, tag, HC15_MAC_TAG_LEN);
+            frame.len += HC15_MAC_TAG_LEN;
+        }
+        return true;
+    }
+
+    /*
+     * @brief CMAC over the header (hop count masked, relays rewrite it) and payload + epoch.
+     */
+    bool tagFrame(const HC15Frame &frame, uint8_t tag[16])
+    {
+        uint8_t hdr[HC15_FRAME_HEADER_LEN];
+        hdr[0] = frame.flags & ~HC15_FLAG_HOPS_MASK;
+        HC15FrameCodec::put16(hdr + 1, frame.dst);
+        HC15FrameCodec::put16(hdr + 3, frame.src);
+        hdr[5] = frame.type;
+        HC15FrameCodec::put16(hdr + 6, frame.seq);
+        hdr[8] = frame.port;
+        return mac_->compute(hdr, sizeof(hdr), frame.payload, frame.len, tag);
+    }
+
+    /*
+     * @brief Check the tag and strip the trailer.
+     * @param epoch Receives the frame's epoch for the replay window.
+     * @return false if the frame must be dropped.
+     */
+    bool verify(HC15Frame &frame, uint32_t &epoch)
+    {
+        epoch = 0;
+        if ((require_mac_ && !(frame.flags & HC15_FLAG_MAC)) || (require_enc_ && !(frame.flags & HC15_FLAG_ENC)))
+            return false;
+        if (!(frame.flags & (HC15_FLAG_ENC | HC15_FLAG_MAC)))
+            return true;
+        if (frame.len < HC15_CRYPTO_EPOCH_LEN + (frame.flags & HC15_FLAG_MAC ? HC15_MAC_TAG_LEN : 0))
+            return false;
+        if (frame.flags & HC15_FLAG_MAC)
+        {
+            if (!mac_)
+                return false;
+            frame.len -= HC15_MAC_TAG_LEN;
+            uint8_t tag[16];
+            if (!tagFrame(frame, tag) || !HC15Cmac::equal(tag, frame.payload + frame.len, HC15_MAC_TAG_LEN))
+                return false;
+        }
+        frame.len -= HC15_CRYPTO_EPOCH_LEN;
+        for (uint8_t i = 0; i < HC15_CRYPTO_EPOCH_LEN; i++)
+            epoch |= static_cast<uint32_t>(frame.payload[frame.len + i]) << (8 * i);
+        return true;
+    }
+
+    bool decrypt(HC15Frame &frame, uint32_t epoch)
+    {
+        if (!(frame.flags & HC15_FLAG_ENC))
+            return true;
+        return cipher_ && cipher_->ctr(frame.src, epoch, frame.seq, frame.payload, frame.len);
+    }
+
+    static void onRxBytes(const uint8_t *data, size_t len, void *ctx)
+    {
+        HC15Link *self = static_cast<HC15Link *>(ctx);
+        for (size_t i = 0; i < len; i++)
+        {
+            if (self->parser_.idle())
+                self->rx_first_us_ = self->hc15_->rxByteTime(i); // 可能是 SYNC，不是的话下个字节覆盖
+            if (self->parser_.feed(data[i]))
+            {
+                HC15Frame &frame = self->parser_.frame();
+                frame.rx_first_us = self->rx_first_us_;
+                frame.rx_last_us = self->hc15_->rxByteTime(i);
+                self->deliver(frame);
+            }
+        }
+    }
+
+    void deliver(HC15Frame &frame)
+    {
+        if (forward_hook_ && forward_hook_(frame, forward_ctx_))
+            return;
+        if (filter_.promiscuous && !filter_.addressed(frame.flags, frame.dst))
+            return; // 混杂模式下收到的别人的帧，只给中继看
+        if (frame.src == node_id_)
+            return; // 自己的广播被中继转了回来
+        uint32_t epoch;
+        if (!verify(frame, epoch))
+        {
+            rx_rejected_++; // tag 错误或缺少要求的安全标志，不碰对端状态
+            return;
+        }
+        bool authed = frame.flags & HC15_FLAG_MAC;
+        xSemaphoreTake(peers_lock_, portMAX_DELAY);
+        bool fresh = authed ? peers_.acceptAuth(frame.src, epoch, frame.seq, millis()) : peers_.accept(frame.src, frame.seq, millis());
+        xSemaphoreGive(peers_lock_);
+        if (!fresh && (dedup_ || authed))
+        {
+            rx_duplicates_++; // 认证帧的重复即重放，关了去重也要丢
+            return;
+        }
+        if (!decrypt(frame, epoch))
+        {
+            rx_rejected_++;
+            return;
+        }
+        for (uint8_t i = 0; i < handler_count_; i++)
+        {
+            if (handlers_[i].type == frame.type && handlers_[i].fn(frame, handlers_[i].ctx))
+                return;
+        }
+        if (frame.type == static_cast<uint8_t>(HC15_FRAME_TYPE::DATA) && frame.port != HC15_PORT_DEFAULT)
+        {
+            Port *p = findPort(frame.port);
+            if (p)
+            {
+                if (p->cb && p->cb(frame, p->ctx))
+                    return;
+                if (!p->queue || xQueueSend(p->queue, &frame, 0) != pdTRUE)
+                    p->dropped++; // 只丢这个端口的，不影响其他服务
+                return;
+            }
+        }
+        if (xQueueSend(rx_queue_, &frame, 0) != pdTRUE)
+            rx_dropped_++; // 消费者太慢，丢最新帧
+    }
+
+    HC15 *hc15_ = nullptr;
+    uint16_t node_id_ = 0;
+    uint8_t hop_limit_ = 0;
+    HC15_FEC_MODE fec_ = HC15_FEC_MODE::OFF;
+    HC15FrameHandler forward_hook_ = nullptr;
+    void *forward_ctx_ = nullptr;
+    uint16_t tx_seq_ = 0;
+    HC15Cipher *cipher_ = nullptr;
+    bool require_enc_ = false;
+    HC15Cmac *mac_ = nullptr;
+    bool require_mac_ = false;
+    uint32_t epoch_ = 0;
+    portMUX_TYPE tx_seq_mux_ = portMUX_INITIALIZER_UNLOCKED; // 保护 tx_seq_ / epoch_
+    QueueHandle_t rx_queue_ = nullptr;
+    HC15AddressFilter filter_;
+    HC15FrameParser parser_;
+    int64_t rx_first_us_ = 0;
+    HC15PeerTable<> peers_;
+    SemaphoreHandle_t peers_lock_ = nullptr;
+    bool dedup_ = true;
+    Handler handlers_[HC15_LINK_MAX_HANDLERS];
+    uint8_t handler_count_ = 0;
+    Port ports_[HC15_LINK_MAX_PORTS];
+    uint8_t port_count_ = 0;
+    uint32_t rx_dropped_ = 0;
+    uint32_t rx_duplicates_ = 0;
+    uint32_t rx_rejected_ = 0;
+};
@@ -0,0 +1,370 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_link.hpp>
+#include <lora_bitmap.hpp>
+
+/*
+ * Reliable multicast with NACK-based repair.
+ *
+ * The sender multicasts every chunk once, then MCAST_END (repeated, since a receiver that misses it
+ * would stay silent; receivers also NACK on their own once the blob goes quiet).
+ * Each receiver with gaps waits a random
+ * part of the NACK window and multicasts one NACK carrying its missing-chunk bitmap; a receiver that
+ * overhears a NACK already covering its gaps stays silent. The sender rebroadcasts the union of
+ * requested chunks and repeats until a whole window passes without NACKs, so airtime grows with the
+ * loss rate rather than with the number of receivers.
+ */
+
+#ifndef HC15_MCAST_MAX_CHUNKS
+#define HC15_MCAST_MAX_CHUNKS 512 // 单个 blob 最多分块数（约 45 KB）
+#endif
+
+#ifndef HC15_MCAST_NACK_WINDOW_MS
+#define HC15_MCAST_NACK_WINDOW_MS 1500 // 每轮结束后收 NACK 的时间
+#endif
+
+#ifndef HC15_MCAST_MAX_ROUNDS
+#define HC15_MCAST_MAX_ROUNDS 8
+#endif
+
+#ifndef HC15_MCAST_END_REPEATS
+#define HC15_MCAST_END_REPEATS 3 // 每轮 END 发几次，丢一个 END 不至于让有缺块的接收端沉默
+#endif
+
+#ifndef HC15_MCAST_END_GAP_MS
+#define HC15_MCAST_END_GAP_MS 100
+#endif
+
+#define HC15_MCAST_CHUNK_HEADER 6
+#define HC15_MCAST_CHUNK_SIZE (HC15_FRAME_MAX_PAYLOAD - HC15_MCAST_CHUNK_HEADER)
+#define HC15_MCAST_NACK_HEADER 4
+#define HC15_MCAST_NACK_BYTES (HC15_FRAME_MAX_PAYLOAD - HC15_MCAST_NACK_HEADER) // 单个 NACK 能带的位图字节
+
+class HC15McastSender
+{
+public:
+    explicit HC15McastSender(HC15Link *link) : link_(link)
+    {
+        lock_ = xSemaphoreCreateMutex();
+    }
+
+    bool begin()
+    {
+        if (!link_ || !lock_)
+            return false;
+        return link_->addHandler(HC15_FRAME_TYPE::MCAST_NACK, &HC15McastSender::onNack, this);
+    }
+
+    /*
+     * @brief Distribute a blob to a group, blocks until every NACK is served or the round limit is hit.
+     * @param group The multicast group, the sender joins it to hear NACKs.
+     * @param blob_id Identifies the transfer so late frames of an older blob are ignored.
+     * @param gap_ms Pause between chunks, paces the channel.
+     * @return true if a full NACK window passed without requests.
+     */
+    bool send(uint16_t group, uint16_t blob_id, uint32_t size, HC15BlobReader reader, void *ctx, uint32_t gap_ms = 0)
+    {
+        uint32_t total = (size + HC15_MCAST_CHUNK_SIZE - 1) / HC15_MCAST_CHUNK_SIZE;
+        if (!reader || total == 0 || total > HC15_MCAST_MAX_CHUNKS)
+            return false;
+        link_->joinGroup(group);
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        group_ = group;
+        blob_id_ = blob_id;
+        total_ = total;
+        pending_.fill(total);
+        xSemaphoreGive(lock_);
+
+        uint8_t payload[HC15_FRAME_MAX_PAYLOAD];
+        for (uint8_t round = 0; round < HC15_MCAST_MAX_ROUNDS; round++)
+        {
+            xSemaphoreTake(lock_, portMAX_DELAY);
+            HC15Bitmap<HC15_MCAST_MAX_CHUNKS> todo = pending_;
+            pending_.clear();
+            xSemaphoreGive(lock_);
+
+            for (int i = todo.firstSet(total); i >= 0; i = todo.firstSet(total, i + 1))
+            {
+                uint32_t offset = static_cast<uint32_t>(i) * HC15_MCAST_CHUNK_SIZE;
+                size_t len = size - offset < HC15_MCAST_CHUNK_SIZE ? size - offset : HC15_MCAST_CHUNK_SIZE;
+                HC15FrameCodec::put16(payload, blob_id);
+                HC15FrameCodec::put16(payload + 2, i);
+                HC15FrameCodec::put16(payload + 4, total);
+                if (reader(offset, payload + HC15_MCAST_CHUNK_HEADER, len, ctx) != len)
+                    return false;
+                if (link_->sendMulticast(group, HC15_FRAME_TYPE::MCAST_CHUNK, payload, HC15_MCAST_CHUNK_HEADER + len))
+                {
+                    chunks_sent_++;
+                    if (round > 0)
+                        repairs_++;
+                }
+                if (gap_ms)
+                    vTaskDelay(pdMS_TO_TICKS(gap_ms));
+            }
+
+            HC15FrameCodec::put16(payload, blob_id);
+            HC15FrameCodec::put16(payload + 2, total);
+            payload[4] = round;
+            for (uint8_t r = 0; r < HC15_MCAST_END_REPEATS; r++)
+            {
+                if (r)
+                    vTaskDelay(pdMS_TO_TICKS(HC15_MCAST_END_GAP_MS));
+                link_->sendMulticast(group, HC15_FRAME_TYPE::MCAST_END, payload, 5);
+            }
+            vTaskDelay(pdMS_TO_TICKS(HC15_MCAST_NACK_WINDOW_MS));
+
+            xSemaphoreTake(lock_, portMAX_DELAY);
+            bool quiet = !pending_.any();
+            xSemaphoreGive(lock_);
+            if (quiet)
+                return true;
+        }
+        return false;
+    }
+
+    uint32_t chunksSent() const { return chunks_sent_; }
+    uint32_t repairs() const { return repairs_; }
+    uint32_t nacks() const { return nacks_; }
+
+private:
+    static bool onNack(const HC15Frame &frame, void *ctx)
+    {
+        HC15McastSender *self = static_cast<HC15McastSender *>(ctx);
+        if (frame.dst != self->group_)
+            return false; // 别的组的 NACK，留给对应的发送端
+        if (frame.len <= HC15_MCAST_NACK_HEADER)
+            return true;
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        if (HC15FrameCodec::get16(frame.payload) == self->blob_id_)
+        {
+            self->pending_.merge(HC15FrameCodec::get16(frame.payload + 2), frame.payload + HC15_MCAST_NACK_HEADER,
+                                 frame.len - HC15_MCAST_NACK_HEADER);
+            self->nacks_++;
+        }
+        xSemaphoreGive(self->lock_);
+        return true;
+    }
+
+    HC15Link *link_ = nullptr;
+    SemaphoreHandle_t lock_ = nullptr;
+    uint16_t group_ = 0;
+    uint16_t blob_id_ = 0;
+    uint32_t total_ = 0;
+    HC15Bitmap<HC15_MCAST_MAX_CHUNKS> pending_; // 下一轮要(重)发的块
+    uint32_t chunks_sent_ = 0;
+    uint32_t repairs_ = 0;
+    uint32_t nacks_ = 0;
+};
+
+class HC15McastReceiver
+{
+public:
+    HC15McastReceiver(HC15Link *link, uint16_t group) : link_(link), group_(group)
+    {
+        lock_ = xSemaphoreCreateMutex();
+    }
+
+    bool begin(HC15BlobWriter writer, void *ctx)
+    {
+        if (!link_ || !lock_ || !writer || !link_->joinGroup(group_))
+            return false;
+        writer_ = writer;
+        writer_ctx_ = ctx;
+        return link_->addHandler(HC15_FRAME_TYPE::MCAST_CHUNK, &HC15McastReceiver::onChunk, this) &&
+               link_->addHandler(HC15_FRAME_TYPE::MCAST_END, &HC15McastReceiver::onEnd, this) &&
+               link_->addHandler(HC15_FRAME_TYPE::MCAST_NACK, &HC15McastReceiver::onNack, this);
+    }
+
+    /*
+     * @brief Send the delayed NACK when it is due, use rtos task please.
+     *        Also arms a NACK when nothing arrives for two windows while gaps remain, so a
+     *        receiver that missed every END of a round still asks for repair.
+     */
+    void nackTask(void * /*pvParameters*/)
+    {
+        uint8_t payload[HC15_FRAME_MAX_PAYLOAD];
+        for (;;)
+        {
+            vTaskDelay(pdMS_TO_TICKS(20));
+            uint8_t len = 0;
+
+            xSemaphoreTake(lock_, portMAX_DELAY);
+            if (total_ && !nack_due_ && !idle_armed_ &&
+                xTaskGetTickCount() - last_rx_ >= pdMS_TO_TICKS(2 * HC15_MCAST_NACK_WINDOW_MS) &&
+                have_.count(total_) < total_)
+            {
+                idle_armed_ = true; // 每段沉默只补一次，收到新块再放开
+                armNack();
+            }
+            if (nack_due_ && static_cast<int32_t>(xTaskGetTickCount() - nack_at_) >= 0)
+            {
+                nack_due_ = false;
+                len = buildNack(payload);
+            }
+            xSemaphoreGive(lock_);
+
+            if (len && link_->sendMulticast(group_, HC15_FRAME_TYPE::MCAST_NACK, payload, len))
+                nacks_sent_++;
+        }
+    }
+
+    bool complete()
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        bool done = total_ && have_.count(total_) == total_;
+        xSemaphoreGive(lock_);
+        return done;
+    }
+
+    uint16_t blobId() const { return blob_id_; }
+    uint32_t size() const { return size_; }
+    uint32_t nacksSent() const { return nacks_sent_; }
+    uint32_t nacksSuppressed() const { return nacks_suppressed_; }
+
+private:
+    /*
+     * @brief Adopt a new blob, forgetting the previous one.
+     */
+    void restart(uint16_t blob_id, uint16_t total)
+    {
+        blob_id_ = blob_id;
+        total_ = total > HC15_MCAST_MAX_CHUNKS ? HC15_MCAST_MAX_CHUNKS : total;
+        size_ = 0;
+        have_.clear();
+        nack_due_ = false;
+        nack_round_ = -1;
+    }
+
+    /*
+     * @brief Schedule a NACK at a random point in the first 3/4 of the window, leaving the sender margin.
+     */
+    void armNack()
+    {
+        uint32_t delay_ms = esp_random() % (HC15_MCAST_NACK_WINDOW_MS * 3 / 4);
+        overheard_.clear();
+        nack_at_ = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+        nack_due_ = true;
+    }
+
+    /*
+     * @brief Bitmap of missing chunks minus what others already asked for, starting at the first gap.
+     * @return The NACK payload length, 0 if nothing is left to ask for.
+     */
+    uint8_t buildNack(uint8_t *payload)
+    {
+        int first = have_.firstClear(total_);
+        if (first < 0)
+            return 0;
+        uint16_t first_byte = first / 8;
+        uint16_t end_byte = (total_ + 7) / 8;
+        uint16_t n = end_byte - first_byte;
+        if (n > HC15_MCAST_NACK_BYTES)
+            n = HC15_MCAST_NACK_BYTES;
+
+        bool any = false;
+        for (uint16_t i = 0; i < n; i++)
+        {
+            uint8_t missing = ~have_.bytes()[first_byte + i] & ~overheard_.bytes()[first_byte + i];
+            if (first_byte + i == end_byte - 1 && total_ % 8)
+                missing &= static_cast<uint8_t>((1u << (total_ % 8)) - 1); // 尾部越界位
+            payload[HC15_MCAST_NACK_HEADER + i] = missing;
+            any |= missing != 0;
+        }
+        if (!any)
+        {
+            nacks_suppressed_++;
+            return 0;
+        }
+        HC15FrameCodec::put16(payload, blob_id_);
+        HC15FrameCodec::put16(payload + 2, first_byte);
+        return HC15_MCAST_NACK_HEADER + n;
+    }
+
+    static bool onChunk(const HC15Frame &frame, void *ctx)
+    {
+        HC15McastReceiver *self = static_cast<HC15McastReceiver *>(ctx);
+        if (frame.dst != self->group_)
+            return false; // 不是本接收端的组，留给其他接收端 / 端口队列
+        if (frame.len <= HC15_MCAST_CHUNK_HEADER)
+            return true;
+        uint16_t blob = HC15FrameCodec::get16(frame.payload);
+        uint16_t idx = HC15FrameCodec::get16(frame.payload + 2);
+        uint16_t total = HC15FrameCodec::get16(frame.payload + 4);
+
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        if (blob != self->blob_id_ || self->total_ == 0)
+            self->restart(blob, total);
+        self->last_rx_ = xTaskGetTickCount();
+        self->idle_armed_ = false;
+        if (idx < self->total_ && !self->have_.test(idx))
+        {
+            uint8_t len = frame.len - HC15_MCAST_CHUNK_HEADER;
+            uint32_t offset = static_cast<uint32_t>(idx) * HC15_MCAST_CHUNK_SIZE;
+            if (self->writer_(offset, frame.payload + HC15_MCAST_CHUNK_HEADER, len, self->writer_ctx_))
+            {
+                self->have_.set(idx);
+                if (idx == self->total_ - 1)
+                    self->size_ = offset + len; // 最后一块决定总长度
+            }
+        }
+        xSemaphoreGive(self->lock_);
+        return true;
+    }
+
+    static bool onEnd(const HC15Frame &frame, void *ctx)
+    {
+        HC15McastReceiver *self = static_cast<HC15McastReceiver *>(ctx);
+        if (frame.dst != self->group_)
+            return false;
+        if (frame.len < 5)
+            return true;
+        uint16_t blob = HC15FrameCodec::get16(frame.payload);
+
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        if (blob != self->blob_id_ || self->total_ == 0)
+            self->restart(blob, HC15FrameCodec::get16(frame.payload + 2)); // 一块都没收到
+        self->last_rx_ = xTaskGetTickCount();
+        // 同一轮的重复 END 只排一次 NACK
+        if (frame.payload[4] != self->nack_round_ && self->have_.count(self->total_) < self->total_)
+        {
+            self->nack_round_ = frame.payload[4];
+            self->armNack();
+        }
+        xSemaphoreGive(self->lock_);
+        return true;
+    }
+
+    static bool onNack(const HC15Frame &frame, void *ctx)
+    {
+        // 别的接收端的 NACK：记下它要过的块，自己就不用再要了
+        HC15McastReceiver *self = static_cast<HC15McastReceiver *>(ctx);
+        if (frame.dst != self->group_ || frame.len <= HC15_MCAST_NACK_HEADER)
+            return false;
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        if (HC15FrameCodec::get16(frame.payload) == self->blob_id_ && self->nack_due_)
+            self->overheard_.merge(HC15FrameCodec::get16(frame.payload + 2), frame.payload + HC15_MCAST_NACK_HEADER,
+                                   frame.len - HC15_MCAST_NACK_HEADER);
+        xSemaphoreGive(self->lock_);
+        return false; // 同一节点上的发送端也要看到
+    }
+
+    HC15Link *link_ = nullptr;
+    uint16_t group_ = 0;
+    SemaphoreHandle_t lock_ = nullptr;
+    HC15BlobWriter writer_ = nullptr;
+    void *writer_ctx_ = nullptr;
+
+    uint16_t blob_id_ = 0;
+    uint16_t total_ = 0;
+    uint32_t size_ = 0;
+    HC15Bitmap<HC15_MCAST_MAX_CHUNKS> have_;
+    HC15Bitmap<HC15_MCAST_MAX_CHUNKS> overheard_;
+    bool nack_due_ = false;
+    TickType_t nack_at_ = 0;
+    int16_t nack_round_ = -1; // 已为哪一轮的 END 排过 NACK
+    TickType_t last_rx_ = 0;  // 最近一次收到本 blob 的块 / END
+    bool idle_armed_ = false;
+    uint32_t nacks_sent_ = 0;
+    uint32_t nacks_suppressed_ = 0;
+};
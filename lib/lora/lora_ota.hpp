@@ -0,0 +1,144 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <lora_xfer.hpp>
+#include <lora_delta.hpp>
+
+/*
+ * Firmware update over the link with delta patches.
+ *
+ * The patch travels as an ordinary resumable transfer (HC15XferSender, id in the OTA range) into a
+ * staging store on the node (LittleFS file, spare data partition ...). Once its SHA-256 checks out,
+ * otaTask() streams it through HC15DeltaApplier: old bytes come from the running partition, new
+ * bytes go straight into the next OTA partition with esp_ota_write(), so neither image is ever held
+ * in RAM. The result must match the target hash in the patch header before the boot partition is
+ * switched.
+ *
+ * Patch format and the streaming applier: lora_delta.hpp.
+ */
+
+#ifndef HC15_OTA_XFER_ID_FIRST
+#define HC15_OTA_XFER_ID_FIRST 0xF000 // 此范围内的传输 id 视为固件补丁
+#endif
+
+#define HC15_OTA_XFER_ID_LAST 0xFFFF
+
+class HC15OtaReceiver
+{
+public:
+    explicit HC15OtaReceiver(HC15Link *link) : xfer_(link, HC15_OTA_XFER_ID_FIRST, HC15_OTA_XFER_ID_LAST) {}
+
+    /*
+     * @param writer, reader Staging store for the patch (at least the patch size).
+     */
+    bool begin(HC15BlobWriter writer, HC15BlobReader reader, void *ctx)
+    {
+        if (!xfer_.begin(writer, reader, ctx))
+            return false;
+        stage_reader_ = reader;
+        stage_ctx_ = ctx;
+        return true;
+    }
+
+    /*
+     * @brief Reboot into the new firmware right after a successful update.
+     */
+    void setAutoRestart(bool enable) { auto_restart_ = enable; }
+
+    /*
+     * @brief The underlying transfer, for setPersist() / resume() of a half received patch.
+     */
+    HC15XferReceiver *xfer() { return &xfer_; }
+
+    /*
+     * @brief Verify and apply received patches, use rtos task please (flash writes take seconds).
+     *        Replaces the transfer's verifyTask(), do not run both.
+     */
+    void otaTask(void * /*pvParameters*/)
+    {
+        for (;;)
+        {
+            if (!xfer_.verify())
+                continue; // 补丁哈希不对，发送端会重传
+            result_ = apply(xfer_.state().size);
+            if (result_ == HC15_OTA_RESULT::OK && auto_restart_)
+                ESP.restart();
+        }
+    }
+
+    /*
+     * @brief Apply a staged patch of patch_size bytes to the running firmware and switch the boot
+     *        partition. Blocking; otaTask() calls it for patches received over the link.
+     */
+    HC15_OTA_RESULT apply(uint32_t patch_size)
+    {
+        const esp_partition_t *running = esp_ota_get_running_partition();
+        const esp_partition_t *target = esp_ota_get_next_update_partition(nullptr);
+        if (!running || !target)
+            return HC15_OTA_RESULT::FLASH_ERROR;
+
+        uint8_t raw[HC15_DELTA_HEADER_LEN];
+        HC15DeltaHeader header;
+        if (patch_size < sizeof(raw) || stage_reader_(0, raw, sizeof(raw), stage_ctx_) != sizeof(raw))
+            return HC15_OTA_RESULT::READ_ERROR;
+        if (!header.parse(raw) || header.base_size > running->size || header.target_size > target->size)
+            return HC15_OTA_RESULT::BAD_PATCH;
+
+        uint8_t sha[32];
+        if (!HC15XferSha256::compute(header.base_size, &HC15OtaReceiver::readPartition, const_cast<esp_partition_t *>(running), sha))
+            return HC15_OTA_RESULT::READ_ERROR;
+        if (memcmp(sha, header.base_sha256, 32) != 0)
+            return HC15_OTA_RESULT::BASE_MISMATCH;
+
+        esp_ota_handle_t handle;
+        if (esp_ota_begin(target, header.target_size, &handle) != ESP_OK)
+            return HC15_OTA_RESULT::FLASH_ERROR;
+
+        HC15DeltaApplier applier;
+        applier.begin(header, &HC15OtaReceiver::readPartition, const_cast<esp_partition_t *>(running), &HC15OtaReceiver::writeOta, &handle);
+        uint8_t buf[HC15_DELTA_BLOCK];
+        bool ok = true;
+        for (uint32_t off = sizeof(raw); off < patch_size && ok;)
+        {
+            size_t len = patch_size - off < sizeof(buf) ? patch_size - off : sizeof(buf);
+            if (stage_reader_(off, buf, len, stage_ctx_) != len)
+            {
+                esp_ota_abort(handle);
+                return HC15_OTA_RESULT::READ_ERROR;
+            }
+            ok = applier.feed(buf, len);
+            off += len;
+        }
+        HC15_OTA_RESULT r = applier.finish();
+        if (r != HC15_OTA_RESULT::OK)
+        {
+            esp_ota_abort(handle);
+            return r;
+        }
+        // esp_ota_end 还会校验镜像格式
+        if (esp_ota_end(handle) != ESP_OK || esp_ota_set_boot_partition(target) != ESP_OK)
+            return HC15_OTA_RESULT::FLASH_ERROR;
+        return HC15_OTA_RESULT::OK;
+    }
+
+    HC15_OTA_RESULT lastResult() const { return result_; }
+
+private:
+    static size_t readPartition(uint32_t offset, uint8_t *out, size_t len, void *ctx)
+    {
+        return esp_partition_read(static_cast<const esp_partition_t *>(ctx), offset, out, len) == ESP_OK ? len : 0;
+    }
+
+    static bool writeOta(uint32_t /*offset*/, const uint8_t *data, size_t len, void *ctx)
+    {
+        // 输出严格按顺序，offset 只是信息
+        return esp_ota_write(*static_cast<esp_ota_handle_t *>(ctx), data, len) == ESP_OK;
+    }
+
+    HC15XferReceiver xfer_;
+    HC15BlobReader stage_reader_ = nullptr;
+    void *stage_ctx_ = nullptr;
+    bool auto_restart_ = false;
+    HC15_OTA_RESULT result_ = HC15_OTA_RESULT::NONE;
+};
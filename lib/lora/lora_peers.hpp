@@ -0,0 +1,497 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <lora_seq.hpp>
+
+/*
+ * Per-peer state for gateways talking to hundreds of nodes.
+ *
+ * Open addressing (linear probing) on the node ID, struct-of-arrays storage: the probe loop only
+ * walks the packed ids_ array, the other columns are touched once the slot is known. The table is
+ * kept at most 3/4 full; beyond that the peer that has been silent longest is evicted. Peers are kept
+ * in recency order on two intrusive lists (plain / authenticated), so the victim is a list tail and
+ * eviction costs O(1) on the RX path however large the table is.
+ *
+ * Authenticated peers leave a replay floor behind when they are evicted or expired: their last
+ * accepted (epoch, seq), kept in a second table of the same layout. A peer without a live window is
+ * only accepted above its floor, so forgetting the window never reopens old frames. The floors can
+ * be saved and restored across reboots (HC15Link::saveReplayFloors()). If the floor table is full an
+ * authenticated peer is only evicted if it already owns a floor, looked for among the
+ * HC15_PEER_EVICT_SCAN stalest; failing that the new peer is refused instead (refused()).
+ */
+
+#ifndef HC15_PEER_CAPACITY
+#define HC15_PEER_CAPACITY 64 // 槽位数，须为 2 的幂，实际最多存 3/4；网关用 build_flags -DHC15_PEER_CAPACITY=512
+#endif
+
+#ifndef HC15_REPLAY_FLOORS
+#define HC15_REPLAY_FLOORS HC15_PEER_CAPACITY // 防重放下限槽位数，2 的幂，最多存 3/4；应覆盖全网认证节点数
+#endif
+
+#ifndef HC15_PEER_EVICT_SCAN
+#define HC15_PEER_EVICT_SCAN 8 // 下限表满时，最多检查几个最久未见的认证对端
+#endif
+
+template <uint16_t CAPACITY = HC15_PEER_CAPACITY, uint16_t FLOORS = HC15_REPLAY_FLOORS>
+class HC15PeerTable
+{
+    static_assert(CAPACITY >= 4 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two >= 4");
+    static_assert(FLOORS >= 4 && (FLOORS & (FLOORS - 1)) == 0, "FLOORS must be a power of two >= 4");
+
+public:
+    static const uint16_t NONE = 0xFFFF;
+    static const uint16_t MAX_PEERS = CAPACITY - CAPACITY / 4;
+    static const uint16_t MAX_FLOORS = FLOORS - FLOORS / 4;
+
+    /*
+     * @brief Replay floors, plain arrays so they can be persisted as one blob.
+     */
+    struct Floors
+    {
+        uint16_t ids[FLOORS];
+        uint32_t epoch[FLOORS];
+        uint16_t seq[FLOORS];
+        uint16_t count;
+    };
+
+    HC15PeerTable()
+    {
+        clear();
+        clearFloors();
+    }
+
+    /*
+     * @brief Forget all peers, the replay floors are kept (see clearFloors()).
+     */
+    void clear()
+    {
+        for (uint16_t i = 0; i < CAPACITY; i++)
+            ids_[i] = EMPTY;
+        for (uint8_t l = 0; l < 2; l++)
+            head_[l] = tail_[l] = NONE;
+        count_ = 0;
+    }
+
+    void clearFloors()
+    {
+        for (uint16_t i = 0; i < FLOORS; i++)
+            floors_.ids[i] = EMPTY;
+        floors_.count = 0;
+    }
+
+    /*
+     * @brief Look up a node.
+     * @return The slot index, or NONE.
+     */
+    uint16_t find(uint16_t id) const
+    {
+        uint16_t i = home(id);
+        for (uint16_t n = 0; n < CAPACITY; n++)
+        {
+            if (ids_[i] == id)
+                return i;
+            if (ids_[i] == EMPTY)
+                return NONE;
+            i = (i + 1) & MASK;
+        }
+        return NONE;
+    }
+
+    /*
+     * @brief Look up a node, inserting it (and evicting the stalest peer if full) when missing.
+     * @return The slot index, or NONE for the reserved broadcast ID or a refused new peer.
+     */
+    uint16_t touch(uint16_t id, uint32_t now_ms)
+    {
+        if (id == EMPTY)
+            return NONE;
+        uint16_t i = home(id);
+        while (ids_[i] != EMPTY)
+        {
+            if (ids_[i] == id)
+            {
+                last_seen_ms_[i] = now_ms;
+                if (head_[auth_[i]] != i)
+                {
+                    unlink(i);
+                    link(i);
+                }
+                return i;
+            }
+            i = (i + 1) & MASK;
+        }
+
+        if (count_ >= MAX_PEERS)
+        {
+            uint16_t victim = stalest(now_ms);
+            if (victim == NONE)
+            {
+                refused_++; // 全是认证对端且下限表已满，宁可不收新节点也不丢防重放状态
+                return NONE;
+            }
+            retire(victim);
+            removeSlot(victim);
+            evictions_++;
+            // 删除会搬动探测链，重新找空位
+            i = home(id);
+            while (ids_[i] != EMPTY)
+                i = (i + 1) & MASK;
+        }
+
+        ids_[i] = id;
+        last_seen_ms_[i] = now_ms;
+        windows_[i].bitmap = 0; // 首帧由 accept() 定基
+        epoch_[i] = 0;
+        auth_[i] = false;
+        srtt_ms_[i] = 0;
+        rx_frames_[i] = 0;
+        lost_frames_[i] = 0;
+        air_speed_[i] = 0;
+        tx_power_[i] = 0;
+        link(i);
+        count_++;
+        return i;
+    }
+
+    /*
+     * @brief RX hot path: refresh last-seen, run the sequence window and update loss counters.
+     * @return false if (id, seq) is a duplicate.
+     */
+    bool accept(uint16_t id, uint16_t seq, uint32_t now_ms)
+    {
+        uint16_t slot = touch(id, now_ms);
+        if (slot == NONE)
+            return true;
+        if (windows_[slot].bitmap == 0)
+        {
+            windows_[slot].reset(seq);
+            rx_frames_[slot]++;
+            return true;
+        }
+        return acceptSlot(slot, seq, false);
+    }
+
+    /*
+     * @brief Replay check for authenticated frames, the counter is (epoch, seq): a newer epoch restarts
+     *        the window, an older one or a seq behind the window is rejected. O(1), no search.
+     * @return false if the frame is a replay or duplicate.
+     */
+    bool acceptAuth(uint16_t id, uint32_t epoch, uint16_t seq, uint32_t now_ms)
+    {
+        uint16_t slot = touch(id, now_ms);
+        if (slot == NONE)
+            return false;
+        if (!auth_[slot] || windows_[slot].bitmap == 0)
+        {
+            // 没有活动窗口（新插入 / 逐出 / 过期 / 重启），由留下的下限判断新旧
+            if (belowFloor(id, epoch, seq))
+                return false;
+            if (!auth_[slot])
+            {
+                unlink(slot); // 换到认证链表
+                auth_[slot] = true;
+                link(slot);
+            }
+            epoch_[slot] = epoch;
+            windows_[slot].reset(seq);
+            rx_frames_[slot]++;
+            return true;
+        }
+        if (epoch > epoch_[slot])
+        {
+            epoch_[slot] = epoch;
+            windows_[slot].reset(seq);
+            rx_frames_[slot]++;
+            return true;
+        }
+        if (epoch < epoch_[slot])
+            return false;
+        return acceptSlot(slot, seq, true);
+    }
+
+    /*
+     * @return false if the node is unknown, or authenticated and its floor cannot be kept.
+     */
+    bool remove(uint16_t id)
+    {
+        uint16_t slot = find(id);
+        if (slot == NONE || !retire(slot))
+            return false;
+        removeSlot(slot);
+        return true;
+    }
+
+    /*
+     * @brief Raise a node's replay floor, authenticated frames at or below (epoch, seq) are rejected
+     *        while the node has no live window.
+     * @return false if the floor table is full.
+     */
+    bool raiseFloor(uint16_t id, uint32_t epoch, uint16_t seq)
+    {
+        uint16_t i = floorSlot(id);
+        if (i == NONE)
+            return false;
+        if (floors_.ids[i] == EMPTY)
+        {
+            floors_.ids[i] = id;
+            floors_.count++;
+        }
+        else if (epoch < floors_.epoch[i] || (epoch == floors_.epoch[i] && seq <= floors_.seq[i]))
+        {
+            return true;
+        }
+        floors_.epoch[i] = epoch;
+        floors_.seq[i] = seq;
+        return true;
+    }
+
+    /*
+     * @brief Copy every live authenticated counter into the floors, before saving them.
+     */
+    void syncFloors()
+    {
+        for (uint16_t i = 0; i < CAPACITY; i++)
+        {
+            if (ids_[i] != EMPTY && !retire(i))
+                break; // 下限表满了，剩下的仍在表里，逐出时再试
+        }
+    }
+
+    Floors &floors() { return floors_; }
+    const Floors &floors() const { return floors_; }
+
+    /*
+     * @brief Fold an RTT sample into the smoothed RTT (EWMA 1/8).
+     */
+    void updateRtt(uint16_t slot, uint32_t rtt_ms)
+    {
+        srtt_ms_[slot] = srtt_ms_[slot] ? srtt_ms_[slot] - srtt_ms_[slot] / 8 + rtt_ms / 8 : rtt_ms;
+    }
+
+    /*
+     * @brief Bulk iteration for housekeeping, fn(slot) is called for every occupied slot.
+     *        Do not insert or remove from inside fn, use expire() for that.
+     */
+    template <typename Fn>
+    void forEach(Fn fn) const
+    {
+        for (uint16_t i = 0; i < CAPACITY; i++)
+        {
+            if (ids_[i] != EMPTY)
+                fn(i);
+        }
+    }
+
+    /*
+     * @brief Drop every peer not heard from for max_age_ms.
+     * @return The number of peers removed.
+     */
+    uint16_t expire(uint32_t now_ms, uint32_t max_age_ms)
+    {
+        uint16_t removed = 0;
+        for (uint16_t i = 0; i < CAPACITY;)
+        {
+            if (ids_[i] != EMPTY && now_ms - last_seen_ms_[i] > max_age_ms && retire(i))
+            {
+                removeSlot(i); // 回填可能把另一个条目移到 i，原地再查一次
+                removed++;
+                continue;
+            }
+            i++;
+        }
+        return removed;
+    }
+
+    uint16_t id(uint16_t slot) const { return ids_[slot]; }
+    uint32_t lastSeen(uint16_t slot) const { return last_seen_ms_[slot]; }
+    uint32_t srtt(uint16_t slot) const { return srtt_ms_[slot]; }
+    uint32_t rxFrames(uint16_t slot) const { return rx_frames_[slot]; }
+    uint32_t lostFrames(uint16_t slot) const { return lost_frames_[slot]; }
+    const HC15SeqWindow &window(uint16_t slot) const { return windows_[slot]; }
+
+    uint8_t airSpeed(uint16_t slot) const { return air_speed_[slot]; }
+    void setAirSpeed(uint16_t slot, uint8_t speed) { air_speed_[slot] = speed; }
+    int8_t txPower(uint16_t slot) const { return tx_power_[slot]; }
+    void setTxPower(uint16_t slot, int8_t dbm) { tx_power_[slot] = dbm; }
+
+    uint16_t count() const { return count_; }
+    uint32_t evictions() const { return evictions_; }
+    uint32_t refused() const { return refused_; }
+
+private:
+    static const uint16_t EMPTY = 0xFFFF; // 广播地址不会是对端
+    static const uint16_t MASK = CAPACITY - 1;
+
+    static uint16_t home(uint16_t id)
+    {
+        return static_cast<uint16_t>((id * 2654435761u) >> 16) & MASK; // Fibonacci 散列，打散连号 ID
+    }
+
+    /*
+     * @brief Floor slot for id: its own, or a free one if there is room.
+     */
+    uint16_t floorSlot(uint16_t id) const
+    {
+        uint16_t i = static_cast<uint16_t>((id * 2654435761u) >> 16) & (FLOORS - 1);
+        while (floors_.ids[i] != EMPTY)
+        {
+            if (floors_.ids[i] == id)
+                return i;
+            i = (i + 1) & (FLOORS - 1);
+        }
+        return floors_.count < MAX_FLOORS ? i : NONE;
+    }
+
+    bool belowFloor(uint16_t id, uint32_t epoch, uint16_t seq) const
+    {
+        uint16_t i = floorSlot(id);
+        if (i == NONE || floors_.ids[i] == EMPTY)
+            return false;
+        // 同一 epoch 内 seq 不回绕（回绕时换 epoch），直接比较
+        return epoch < floors_.epoch[i] || (epoch == floors_.epoch[i] && seq <= floors_.seq[i]);
+    }
+
+    /*
+     * @brief Leave the floor of an authenticated peer behind before its slot goes away.
+     * @return false if it is authenticated and the floor table is full.
+     */
+    bool retire(uint16_t slot)
+    {
+        if (!auth_[slot] || windows_[slot].bitmap == 0)
+            return true;
+        return raiseFloor(ids_[slot], epoch_[slot], windows_[slot].highest);
+    }
+
+    bool acceptSlot(uint16_t slot, uint16_t seq, bool strict)
+    {
+        HC15SeqWindow &w = windows_[slot];
+        int16_t diff = static_cast<int16_t>(seq - w.highest);
+        if (!w.accept(seq, strict))
+            return false;
+        rx_frames_[slot]++;
+        if (diff > 1 && diff < 64)
+            lost_frames_[slot] += diff - 1; // 序号跳变，中间的先记为丢失
+        else if (diff < 0 && diff > -64 && lost_frames_[slot])
+            lost_frames_[slot]--; // 迟到的补上了
+        return true;
+    }
+
+    /*
+     * @brief The peer to evict: the staler of the two list tails. Only with the floor table full does
+     *        an authenticated tail need a floor lookup, and then at most HC15_PEER_EVICT_SCAN of them.
+     */
+    uint16_t stalest(uint32_t now_ms) const
+    {
+        uint16_t plain = tail_[0];
+        uint16_t auth = tail_[1];
+        if (floors_.count >= MAX_FLOORS)
+        {
+            for (uint16_t n = 0; auth != NONE && floorSlot(ids_[auth]) == NONE; n++)
+                auth = n + 1 < HC15_PEER_EVICT_SCAN ? prev_[auth] : NONE; // 下限放不下，不能逐出
+        }
+        if (plain == NONE || auth == NONE)
+            return plain == NONE ? auth : plain;
+        return now_ms - last_seen_ms_[auth] > now_ms - last_seen_ms_[plain] ? auth : plain;
+    }
+
+    /*
+     * @brief Put a slot at the head (most recent end) of its list, auth_ selects the list.
+     */
+    void link(uint16_t slot)
+    {
+        uint8_t l = auth_[slot];
+        prev_[slot] = NONE;
+        next_[slot] = head_[l];
+        if (head_[l] != NONE)
+            prev_[head_[l]] = slot;
+        else
+            tail_[l] = slot;
+        head_[l] = slot;
+    }
+
+    void unlink(uint16_t slot)
+    {
+        uint8_t l = auth_[slot];
+        if (prev_[slot] != NONE)
+            next_[prev_[slot]] = next_[slot];
+        else
+            head_[l] = next_[slot];
+        if (next_[slot] != NONE)
+            prev_[next_[slot]] = prev_[slot];
+        else
+            tail_[l] = prev_[slot];
+    }
+
+    /*
+     * @brief Move an occupied slot into the free slot to, taking its place in the recency list.
+     */
+    void moveSlot(uint16_t to, uint16_t from)
+    {
+        uint8_t l = auth_[from];
+        prev_[to] = prev_[from];
+        next_[to] = next_[from];
+        if (prev_[to] != NONE)
+            next_[prev_[to]] = to;
+        else
+            head_[l] = to;
+        if (next_[to] != NONE)
+            prev_[next_[to]] = to;
+        else
+            tail_[l] = to;
+
+        ids_[to] = ids_[from];
+        last_seen_ms_[to] = last_seen_ms_[from];
+        windows_[to] = windows_[from];
+        epoch_[to] = epoch_[from];
+        auth_[to] = auth_[from];
+        srtt_ms_[to] = srtt_ms_[from];
+        rx_frames_[to] = rx_frames_[from];
+        lost_frames_[to] = lost_frames_[from];
+        air_speed_[to] = air_speed_[from];
+        tx_power_[to] = tx_power_[from];
+    }
+
+    /*
+     * @brief Backward-shift deletion, keeps probe chains intact without tombstones.
+     */
+    void removeSlot(uint16_t hole)
+    {
+        unlink(hole);
+        uint16_t j = hole;
+        for (;;)
+        {
+            j = (j + 1) & MASK;
+            if (ids_[j] == EMPTY)
+                break;
+            uint16_t h = home(ids_[j]);
+            // j 的理想位置不在 (hole, j] 之间，就可以回填到 hole
+            bool stays = (hole <= j) ? (hole < h && h <= j) : (hole < h || h <= j);
+            if (!stays)
+            {
+                moveSlot(hole, j);
+                hole = j;
+            }
+        }
+        ids_[hole] = EMPTY;
+        count_--;
+    }
+
+    uint16_t ids_[CAPACITY];
+    uint32_t last_seen_ms_[CAPACITY];
+    HC15SeqWindow windows_[CAPACITY];
+    uint32_t epoch_[CAPACITY]; // 认证帧的 epoch，配合 windows_ 做防重放
+    bool auth_[CAPACITY];      // 窗口由认证帧建立，逐出时要留下限
+    uint32_t srtt_ms_[CAPACITY];
+    uint32_t rx_frames_[CAPACITY];
+    uint32_t lost_frames_[CAPACITY];
+    uint8_t air_speed_[CAPACITY];
+    int8_t tx_power_[CAPACITY];
+    uint16_t prev_[CAPACITY]; // 最近使用链表，按 auth_ 分两条，head 最新、tail 最久未见
+    uint16_t next_[CAPACITY];
+    uint16_t head_[2];
+    uint16_t tail_[2];
+    uint16_t count_ = 0;
+    uint32_t evictions_ = 0;
+    uint32_t refused_ = 0;
+    Floors floors_;
+};
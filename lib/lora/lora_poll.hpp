@@ -0,0 +1,284 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_link.hpp>
+
+/*
+ * Gateway-driven polling MAC.
+ *
+ * The gateway (HC15PollMaster) is the only station that talks unsolicited: it picks a node from a
+ * smooth weighted round-robin schedule, sends it a POLL carrying a frame budget and waits for POLL_END.
+ * A node (HC15PollNode) stays silent until polled, then answers with one UART burst containing up to
+ * budget queued DATA frames followed by POLL_END(remaining). No two nodes ever transmit at once.
+ */
+
+#ifndef HC15_POLL_QUEUE_DEPTH
+#define HC15_POLL_QUEUE_DEPTH 8 // 节点侧待发帧数
+#endif
+
+#ifndef HC15_POLL_BATCH_BYTES
+#define HC15_POLL_BATCH_BYTES 256 // 一次应答的 UART 突发上限
+#endif
+
+#ifndef HC15_POLL_MAX_NODES
+#define HC15_POLL_MAX_NODES 32
+#endif
+
+#define HC15_POLL_MIN_WEIGHT 4   // 权重下限 (Q4, 0.25 帧)，保证空闲节点也会被轮到
+#define HC15_POLL_SLEEPY_MISSES 3 // 连续多少次不应答视为休眠
+
+class HC15PollNode
+{
+public:
+    explicit HC15PollNode(HC15Link *link) : link_(link)
+    {
+        tx_queue_ = xQueueCreate(HC15_POLL_QUEUE_DEPTH, sizeof(HC15Frame));
+    }
+
+    bool begin()
+    {
+        if (!link_ || !tx_queue_)
+            return false;
+        return link_->addHandler(HC15_FRAME_TYPE::POLL, &HC15PollNode::onPoll, this);
+    }
+
+    /*
+     * @brief Queue a payload for the gateway, it goes out on the next poll.
+     * @param port Logical port on the gateway side.
+     * @return false if the payload is too long or the queue is full.
+     */
+    bool enqueue(const uint8_t *payload, uint8_t len, uint8_t port = HC15_PORT_DEFAULT)
+    {
+        if (len > HC15_FRAME_MAX_PAYLOAD || (len && !payload))
+            return false;
+        HC15Frame frame;
+        frame.flags = 0;
+        frame.type = static_cast<uint8_t>(HC15_FRAME_TYPE::DATA);
+        frame.port = port;
+        frame.len = len;
+        if (len)
+            memcpy(frame.payload, payload, len);
+        return xQueueSend(tx_queue_, &frame, 0) == pdTRUE;
+    }
+
+    int queued()
+    {
+        return uxQueueMessagesWaiting(tx_queue_);
+    }
+
+    uint32_t pollsAnswered() const { return polls_answered_; }
+
+private:
+    static bool onPoll(const HC15Frame &frame, void *ctx)
+    {
+        static_cast<HC15PollNode *>(ctx)->answer(frame);
+        return true;
+    }
+
+    void answer(const HC15Frame &poll)
+    {
+        if (poll.dst != link_->nodeId())
+            return; // 广播的 POLL 不应答，避免所有节点同时发
+
+        uint8_t budget = poll.len ? poll.payload[0] : 1;
+        size_t used = 0;
+        const size_t overhead = link_->wireOverhead();
+        const size_t reserve = overhead + 1; // 给 POLL_END 留位置
+
+        while (budget > 0 && xQueuePeek(tx_queue_, &scratch_, 0) == pdTRUE)
+        {
+            if (used + overhead + scratch_.len + reserve > sizeof(batch_))
+                break;
+            xQueueReceive(tx_queue_, &scratch_, 0);
+            scratch_.dst = poll.src;
+            used += link_->encode(scratch_, batch_ + used, sizeof(batch_) - used);
+            budget--;
+        }
+
+        int left = queued();
+        scratch_.flags = 0;
+        scratch_.type = static_cast<uint8_t>(HC15_FRAME_TYPE::POLL_END);
+        scratch_.dst = poll.src;
+        scratch_.port = HC15_PORT_DEFAULT;
+        scratch_.len = 1;
+        scratch_.payload[0] = static_cast<uint8_t>(left > 255 ? 255 : left);
+        used += link_->encode(scratch_, batch_ + used, sizeof(batch_) - used);
+
+        if (link_->driver()->send(batch_, used) == static_cast<int>(used))
+            polls_answered_++;
+    }
+
+    HC15Link *link_ = nullptr;
+    QueueHandle_t tx_queue_ = nullptr;
+    HC15Frame scratch_;
+    uint8_t batch_[HC15_POLL_BATCH_BYTES];
+    uint32_t polls_answered_ = 0;
+};
+
+template <uint16_t MAX_NODES = HC15_POLL_MAX_NODES>
+class HC15PollMaster
+{
+public:
+    HC15PollMaster(HC15Link *link, uint32_t response_timeout_ms = 500) : link_(link), response_timeout_ms_(response_timeout_ms)
+    {
+        done_ = xSemaphoreCreateBinary();
+    }
+
+    bool begin()
+    {
+        if (!link_ || !done_)
+            return false;
+        return link_->addHandler(HC15_FRAME_TYPE::POLL_END, &HC15PollMaster::onPollEnd, this) &&
+               link_->addHandler(HC15_FRAME_TYPE::DATA, &HC15PollMaster::onData, this);
+    }
+
+    bool addNode(uint16_t id)
+    {
+        if (id == HC15_BROADCAST_ID || findNode(id) >= 0 || node_count_ >= MAX_NODES)
+            return false;
+        nodes_[node_count_++] = {id, 1 << 4, 0, 0, 0}; // 初始按每次 1 帧估计
+        return true;
+    }
+
+    bool removeNode(uint16_t id)
+    {
+        int idx = findNode(id);
+        if (idx < 0)
+            return false;
+        nodes_[idx] = nodes_[--node_count_];
+        return true;
+    }
+
+    /*
+     * @brief Max frames a node may send per poll.
+     */
+    void setBudget(uint8_t frames) { budget_ = frames ? frames : 1; }
+
+    /*
+     * @brief Pick the next node: smooth weighted round-robin over recent traffic.
+     * @return The node index, or -1 if no node is registered.
+     */
+    int nextNode()
+    {
+        if (node_count_ == 0)
+            return -1;
+        int32_t total = 0;
+        int best = 0;
+        for (uint16_t i = 0; i < node_count_; i++)
+        {
+            int32_t w = effectiveWeight(nodes_[i]);
+            nodes_[i].current += w;
+            total += w;
+            if (nodes_[i].current > nodes_[best].current)
+                best = i;
+        }
+        nodes_[best].current -= total;
+        return best;
+    }
+
+    /*
+     * @brief Poll the next scheduled node and wait for its POLL_END.
+     * @return true if the node answered within the response timeout.
+     */
+    bool pollOnce()
+    {
+        int idx = nextNode();
+        if (idx < 0)
+            return false;
+        Node &node = nodes_[idx];
+
+        xSemaphoreTake(done_, 0); // 清掉上一轮迟到的信号
+        got_ = 0;
+        backlog_ = 0;
+        polling_id_ = node.id;
+
+        uint8_t budget = budget_;
+        bool answered = link_->send(node.id, HC15_FRAME_TYPE::POLL, &budget, 1) &&
+                        xSemaphoreTake(done_, pdMS_TO_TICKS(response_timeout_ms_)) == pdTRUE;
+        polling_id_ = HC15_BROADCAST_ID;
+
+        // EWMA(1/4) of (frames delivered + frames still waiting), Q4
+        int32_t sample = answered ? static_cast<int32_t>(got_ + backlog_) << 4 : 0;
+        node.weight_q4 += (sample - node.weight_q4) / 4;
+        node.missed = answered ? 0 : (node.missed < 255 ? node.missed + 1 : 255);
+        polls_++;
+        if (!answered)
+            timeouts_++;
+        return answered;
+    }
+
+    /*
+     * @brief Poll forever, use rtos task please.
+     * @param pvParameters Idle gap between polls in ms (caps the aggregate channel load).
+     */
+    void pollTask(void *pvParameters)
+    {
+        uint32_t gap_ms = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pvParameters));
+        for (;;)
+        {
+            if (!pollOnce() && node_count_ == 0)
+                vTaskDelay(pdMS_TO_TICKS(100)); // 没有节点时别空转
+            vTaskDelay(pdMS_TO_TICKS(gap_ms ? gap_ms : 1));
+        }
+    }
+
+    uint16_t nodeCount() const { return node_count_; }
+    uint32_t polls() const { return polls_; }
+    uint32_t timeouts() const { return timeouts_; }
+
+private:
+    struct Node
+    {
+        uint16_t id;
+        int32_t weight_q4; // 最近每次轮询带回的帧数，Q4 定点
+        int32_t current;   // SWRR 当前值
+        uint8_t missed;    // 连续未应答次数
+        uint8_t reserved;
+    };
+
+    static int32_t effectiveWeight(const Node &node)
+    {
+        if (node.missed >= HC15_POLL_SLEEPY_MISSES)
+            return 1; // 休眠节点偶尔探一下
+        return node.weight_q4 + HC15_POLL_MIN_WEIGHT;
+    }
+
+    int findNode(uint16_t id) const
+    {
+        for (uint16_t i = 0; i < node_count_; i++)
+        {
+            if (nodes_[i].id == id)
+                return i;
+        }
+        return -1;
+    }
+
+    static bool onPollEnd(const HC15Frame &frame, void *ctx)
+    {
+        HC15PollMaster *self = static_cast<HC15PollMaster *>(ctx);
+        if (frame.src != self->polling_id_)
+            return true; // 过期的应答
+        self->backlog_ = frame.len ? frame.payload[0] : 0;
+        xSemaphoreGive(self->done_);
+        return true;
+    }
+
+    static bool onData(const HC15Frame &frame, void *ctx)
+    {
+        HC15PollMaster *self = static_cast<HC15PollMaster *>(ctx);
+        if (frame.src == self->polling_id_)
+            self->got_++;
+        return false; // 只计数，数据照常进接收队列
+    }
+
+    HC15Link *link_ = nullptr;
+    uint32_t response_timeout_ms_ = 500;
+    SemaphoreHandle_t done_ = nullptr;
+    Node nodes_[MAX_NODES];
+    uint16_t node_count_ = 0;
+    uint8_t budget_ = 4;
+    volatile uint16_t polling_id_ = HC15_BROADCAST_ID;
+    volatile uint16_t got_ = 0;
+    volatile uint8_t backlog_ = 0;
+    uint32_t polls_ = 0;
+    uint32_t timeouts_ = 0;
+};
@@ -0,0 +1,434 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_link.hpp>
+
+/*
+ * iperf-style link test between two HC15 nodes, entirely in firmware.
+ *
+ * One node runs HC15ProbeResponder, the other HC15ProbeInitiator: timed echo probes give the RTT
+ * distribution, jitter and loss, a bulk stream gives goodput and loss. sweep() repeats the test at
+ * several air speeds; both ends switch with setSpeed() after a SPEED handshake at the old speed, and
+ * the responder falls back to its home speed when nothing arrives for HC15_PROBE_REVERT_MS, so a
+ * speed that does not work cannot strand the pair.
+ *
+ * PROBE payload: op(1) + fields
+ *   ECHO_REQ / ECHO_REP: id(2) + padding, the reply echoes the request
+ *   BULK:                run(1) + index(2) + padding
+ *   BULK_END:            run(1) + frames sent(2)
+ *   BULK_REPORT:         run(1) + frames(2) + bytes(4) + first-to-last span us(4)
+ *   SPEED / SPEED_ACK:   speed(1)
+ */
+
+#ifndef HC15_PROBE_MAX_PINGS
+#define HC15_PROBE_MAX_PINGS 32 // RTT 样本数上限，用于分位数
+#endif
+
+#ifndef HC15_PROBE_TIMEOUT_MS
+#define HC15_PROBE_TIMEOUT_MS 3000 // 单个探测 / 报告的等待时间
+#endif
+
+#ifndef HC15_PROBE_SETTLE_MS
+#define HC15_PROBE_SETTLE_MS 500 // 切换空速前等对端的 ACK 发完
+#endif
+
+#ifndef HC15_PROBE_REVERT_MS
+#define HC15_PROBE_REVERT_MS 15000 // 响应端无探测帧多久回到原空速
+#endif
+
+#define HC15_PROBE_MAX_SPEEDS 8
+
+enum class HC15_PROBE_OP : uint8_t
+{
+    ECHO_REQ = 1,
+    ECHO_REP = 2,
+    BULK = 3,
+    BULK_END = 4,
+    BULK_REPORT = 5,
+    SPEED = 6,
+    SPEED_ACK = 7,
+};
+
+struct HC15ProbeResult
+{
+    uint8_t speed = 0;      // 0 = 当前空速，未切换
+    bool reachable = false; // 空速切换握手成功且至少一个探测有回应
+    uint8_t pings_sent = 0;
+    uint8_t pings_lost = 0;
+    uint32_t rtt_min_us = 0;
+    uint32_t rtt_p50_us = 0;
+    uint32_t rtt_p90_us = 0;
+    uint32_t rtt_max_us = 0;
+    uint32_t jitter_us = 0; // 相邻 RTT 差的平均值
+    uint16_t bulk_sent = 0;
+    uint16_t bulk_received = 0;
+    uint32_t goodput_bps = 0; // 应用负载比特率，按接收端首尾帧时间计算
+};
+
+class HC15ProbeResponder
+{
+public:
+    HC15ProbeResponder(HC15Link *link, HC15 *hc15) : link_(link), hc15_(hc15)
+    {
+        lock_ = xSemaphoreCreateMutex();
+    }
+
+    /*
+     * @param home_speed The configured air speed (1-8), restored after a sweep or when a test speed fails.
+     */
+    bool begin(uint8_t home_speed)
+    {
+        if (!link_ || !hc15_ || !lock_)
+            return false;
+        home_speed_ = current_speed_ = home_speed;
+        return link_->addHandler(HC15_FRAME_TYPE::PROBE, &HC15ProbeResponder::onProbe, this);
+    }
+
+    /*
+     * @brief Applies speed changes outside the receive path, use rtos task please.
+     */
+    void responderTask(void * /*pvParameters*/)
+    {
+        for (;;)
+        {
+            xSemaphoreTake(lock_, portMAX_DELAY);
+            uint8_t target = pending_speed_;
+            pending_speed_ = 0;
+            if (!target && current_speed_ != home_speed_ && millis() - last_ms_ >= HC15_PROBE_REVERT_MS)
+                target = home_speed_; // 新空速上一直没人说话，回家
+            xSemaphoreGive(lock_);
+
+            if (target && target != current_speed_)
+            {
+                vTaskDelay(pdMS_TO_TICKS(HC15_PROBE_SETTLE_MS)); // 让 SPEED_ACK 先发出去
+                hc15_->setSpeed(target);
+                xSemaphoreTake(lock_, portMAX_DELAY);
+                current_speed_ = target;
+                last_ms_ = millis();
+                xSemaphoreGive(lock_);
+            }
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+    }
+
+private:
+    static bool onProbe(const HC15Frame &frame, void *ctx)
+    {
+        HC15ProbeResponder *self = static_cast<HC15ProbeResponder *>(ctx);
+        if (frame.len < 1)
+            return true;
+        uint8_t out[HC15_FRAME_MAX_PAYLOAD];
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        self->last_ms_ = millis();
+        xSemaphoreGive(self->lock_);
+
+        switch (static_cast<HC15_PROBE_OP>(frame.payload[0]))
+        {
+        case HC15_PROBE_OP::ECHO_REQ:
+            memcpy(out, frame.payload, frame.len);
+            out[0] = static_cast<uint8_t>(HC15_PROBE_OP::ECHO_REP);
+            self->link_->send(frame.src, HC15_FRAME_TYPE::PROBE, out, frame.len);
+            break;
+
+        case HC15_PROBE_OP::BULK:
+            if (frame.len < 4)
+                break;
+            if (frame.payload[1] != self->run_)
+            {
+                self->run_ = frame.payload[1];
+                self->frames_ = 0;
+                self->bytes_ = 0;
+                self->first_us_ = frame.rx_last_us;
+            }
+            self->frames_++;
+            self->bytes_ += frame.len;
+            self->last_us_ = frame.rx_last_us;
+            break;
+
+        case HC15_PROBE_OP::BULK_END:
+        {
+            if (frame.len < 2)
+                break;
+            bool same = frame.payload[1] == self->run_;
+            out[0] = static_cast<uint8_t>(HC15_PROBE_OP::BULK_REPORT);
+            out[1] = frame.payload[1];
+            HC15FrameCodec::put16(out + 2, same ? self->frames_ : 0);
+            uint32_t bytes = same ? self->bytes_ : 0;
+            uint32_t span = same ? static_cast<uint32_t>(self->last_us_ - self->first_us_) : 0;
+            for (uint8_t i = 0; i < 4; i++)
+            {
+                out[4 + i] = static_cast<uint8_t>(bytes >> (8 * i));
+                out[8 + i] = static_cast<uint8_t>(span >> (8 * i));
+            }
+            self->link_->send(frame.src, HC15_FRAME_TYPE::PROBE, out, 12);
+            break;
+        }
+
+        case HC15_PROBE_OP::SPEED:
+            if (frame.len < 2 || frame.payload[1] < 1 || frame.payload[1] > 8)
+                break;
+            out[0] = static_cast<uint8_t>(HC15_PROBE_OP::SPEED_ACK);
+            out[1] = frame.payload[1];
+            self->link_->send(frame.src, HC15_FRAME_TYPE::PROBE, out, 2);
+            xSemaphoreTake(self->lock_, portMAX_DELAY);
+            self->pending_speed_ = frame.payload[1];
+            xSemaphoreGive(self->lock_);
+            break;
+
+        default:
+            return false; // 响应端不处理的 op，给同一节点上的发起端
+        }
+        return true;
+    }
+
+    HC15Link *link_ = nullptr;
+    HC15 *hc15_ = nullptr;
+    SemaphoreHandle_t lock_ = nullptr;
+    uint8_t home_speed_ = 0;
+    uint8_t current_speed_ = 0;
+    uint8_t pending_speed_ = 0;
+    uint32_t last_ms_ = 0;
+    uint8_t run_ = 0;
+    uint16_t frames_ = 0;
+    uint32_t bytes_ = 0;
+    int64_t first_us_ = 0;
+    int64_t last_us_ = 0;
+};
+
+class HC15ProbeInitiator
+{
+public:
+    HC15ProbeInitiator(HC15Link *link, HC15 *hc15, uint16_t peer) : link_(link), hc15_(hc15), peer_(peer)
+    {
+        replies_ = xQueueCreate(4, sizeof(Reply));
+    }
+
+    bool begin()
+    {
+        if (!link_ || !hc15_ || !replies_)
+            return false;
+        return link_->addHandler(HC15_FRAME_TYPE::PROBE, &HC15ProbeInitiator::onReply, this);
+    }
+
+    /*
+     * @brief Measure at the current air speed, blocking.
+     * @param pings Echo probes, up to HC15_PROBE_MAX_PINGS.
+     * @param bulk_frames Frames in the throughput stream, 0 skips it.
+     * @param payload_len Probe and bulk payload size, 12 .. HC15_FRAME_MAX_PAYLOAD.
+     */
+    HC15ProbeResult run(uint8_t pings, uint16_t bulk_frames, uint8_t payload_len = HC15_FRAME_MAX_PAYLOAD)
+    {
+        HC15ProbeResult r;
+        if (payload_len < 12)
+            payload_len = 12;
+        if (payload_len > HC15_FRAME_MAX_PAYLOAD)
+            payload_len = HC15_FRAME_MAX_PAYLOAD;
+        if (pings > HC15_PROBE_MAX_PINGS)
+            pings = HC15_PROBE_MAX_PINGS;
+
+        uint8_t out[HC15_FRAME_MAX_PAYLOAD];
+        memset(out, 0xA5, sizeof(out));
+        uint32_t rtt[HC15_PROBE_MAX_PINGS];
+        uint8_t got = 0;
+        uint64_t jitter_sum = 0;
+        xQueueReset(replies_);
+
+        for (uint8_t i = 0; i < pings; i++)
+        {
+            out[0] = static_cast<uint8_t>(HC15_PROBE_OP::ECHO_REQ);
+            HC15FrameCodec::put16(out + 1, ++echo_id_);
+            int64_t t0 = esp_timer_get_time();
+            r.pings_sent++;
+            Reply rep;
+            if (!link_->send(peer_, HC15_FRAME_TYPE::PROBE, out, payload_len) ||
+                !await(HC15_PROBE_OP::ECHO_REP, rep, echo_id_))
+            {
+                r.pings_lost++;
+                continue;
+            }
+            // 回包的接收时间取自 UART 事件，不受本任务调度影响
+            uint32_t sample = static_cast<uint32_t>(rep.rx_us - t0);
+            if (got)
+                jitter_sum += sample > rtt[got - 1] ? sample - rtt[got - 1] : rtt[got - 1] - sample;
+            rtt[got++] = sample;
+        }
+        if (got)
+        {
+            r.reachable = true;
+            r.jitter_us = got > 1 ? static_cast<uint32_t>(jitter_sum / (got - 1)) : 0;
+            sortSamples(rtt, got);
+            r.rtt_min_us = rtt[0];
+            r.rtt_p50_us = rtt[got / 2];
+            r.rtt_p90_us = rtt[(got * 9) / 10 < got ? (got * 9) / 10 : got - 1];
+            r.rtt_max_us = rtt[got - 1];
+        }
+
+        if (bulk_frames && (got || !pings))
+        {
+            run_++;
+            out[0] = static_cast<uint8_t>(HC15_PROBE_OP::BULK);
+            out[1] = run_;
+            for (uint16_t i = 0; i < bulk_frames; i++)
+            {
+                HC15FrameCodec::put16(out + 2, i);
+                if (link_->send(peer_, HC15_FRAME_TYPE::PROBE, out, payload_len))
+                    r.bulk_sent++;
+            }
+            out[0] = static_cast<uint8_t>(HC15_PROBE_OP::BULK_END);
+            HC15FrameCodec::put16(out + 2, r.bulk_sent);
+            for (uint8_t attempt = 0; attempt < 3; attempt++)
+            {
+                Reply rep;
+                link_->send(peer_, HC15_FRAME_TYPE::PROBE, out, 4);
+                if (!await(HC15_PROBE_OP::BULK_REPORT, rep, run_))
+                    continue;
+                r.bulk_received = HC15FrameCodec::get16(rep.data + 1);
+                uint32_t bytes = 0, span = 0;
+                for (uint8_t b = 0; b < 4; b++)
+                {
+                    bytes |= static_cast<uint32_t>(rep.data[3 + b]) << (8 * b);
+                    span |= static_cast<uint32_t>(rep.data[7 + b]) << (8 * b);
+                }
+                // span 从第一帧收完算起，所以不含第一帧
+                if (span && r.bulk_received > 1)
+                    r.goodput_bps = static_cast<uint32_t>((static_cast<uint64_t>(bytes - bytes / r.bulk_received) * 8000000ull) / span);
+                r.reachable = true;
+                break;
+            }
+        }
+        return r;
+    }
+
+    /*
+     * @brief Run the test at each air speed and return to home_speed afterwards.
+     * @return The number of results written.
+     */
+    uint8_t sweep(const uint8_t *speeds, uint8_t count, uint8_t home_speed, HC15ProbeResult *results, uint8_t pings,
+                  uint16_t bulk_frames, uint8_t payload_len = HC15_FRAME_MAX_PAYLOAD)
+    {
+        uint8_t n = 0;
+        uint8_t current = home_speed;
+        for (uint8_t i = 0; i < count && i < HC15_PROBE_MAX_SPEEDS; i++)
+        {
+            HC15ProbeResult &r = results[n++];
+            if (!switchSpeed(speeds[i], current))
+            {
+                r = HC15ProbeResult();
+                r.speed = speeds[i];
+                continue;
+            }
+            r = run(pings, bulk_frames, payload_len);
+            r.speed = speeds[i];
+            if (!r.reachable && current != home_speed)
+            {
+                // 这个空速不通，本端先回家，等对端超时回退
+                hc15_->setSpeed(home_speed);
+                current = home_speed;
+                vTaskDelay(pdMS_TO_TICKS(HC15_PROBE_REVERT_MS + HC15_PROBE_SETTLE_MS));
+            }
+        }
+        if (current != home_speed && !switchSpeed(home_speed, current))
+        {
+            hc15_->setSpeed(home_speed);
+            vTaskDelay(pdMS_TO_TICKS(HC15_PROBE_REVERT_MS + HC15_PROBE_SETTLE_MS));
+        }
+        return n;
+    }
+
+    static void print(Stream *out, const HC15ProbeResult &r)
+    {
+        out->printf("speed %u: %s, ping %u/%u lost, rtt min/p50/p90/max %lu/%lu/%lu/%lu us, jitter %lu us, "
+                    "bulk %u/%u, goodput %lu bit/s\n",
+                    r.speed, r.reachable ? "ok" : "unreachable", r.pings_lost, r.pings_sent,
+                    static_cast<unsigned long>(r.rtt_min_us), static_cast<unsigned long>(r.rtt_p50_us),
+                    static_cast<unsigned long>(r.rtt_p90_us), static_cast<unsigned long>(r.rtt_max_us),
+                    static_cast<unsigned long>(r.jitter_us), r.bulk_received, r.bulk_sent,
+                    static_cast<unsigned long>(r.goodput_bps));
+    }
+
+private:
+    struct Reply
+    {
+        uint8_t op;
+        uint8_t data[11]; // op 之后的字段，最长是 BULK_REPORT
+        int64_t rx_us;
+    };
+
+    /*
+     * @brief SPEED handshake at the current speed, then switch both ends.
+     */
+    bool switchSpeed(uint8_t speed, uint8_t &current)
+    {
+        if (speed == current)
+            return true;
+        uint8_t out[2] = {static_cast<uint8_t>(HC15_PROBE_OP::SPEED), speed};
+        for (uint8_t attempt = 0; attempt < 3; attempt++)
+        {
+            Reply rep;
+            link_->send(peer_, HC15_FRAME_TYPE::PROBE, out, sizeof(out));
+            if (!await(HC15_PROBE_OP::SPEED_ACK, rep, speed))
+                continue;
+            hc15_->setSpeed(speed);
+            current = speed;
+            vTaskDelay(pdMS_TO_TICKS(2 * HC15_PROBE_SETTLE_MS)); // 对端 SETTLE 后才切换
+            return true;
+        }
+        return false;
+    }
+
+    /*
+     * @brief Wait for a reply with the given op whose first field matches key, dropping stale ones.
+     */
+    bool await(HC15_PROBE_OP op, Reply &rep, uint16_t key)
+    {
+        uint32_t start = millis();
+        for (;;)
+        {
+            uint32_t spent = millis() - start;
+            if (spent >= HC15_PROBE_TIMEOUT_MS ||
+                xQueueReceive(replies_, &rep, pdMS_TO_TICKS(HC15_PROBE_TIMEOUT_MS - spent)) != pdTRUE)
+                return false;
+            if (rep.op != static_cast<uint8_t>(op))
+                continue;
+            uint16_t field = op == HC15_PROBE_OP::ECHO_REP ? HC15FrameCodec::get16(rep.data) : rep.data[0];
+            if (field == key)
+                return true; // 其他的是超时后才到的旧回包
+        }
+    }
+
+    static void sortSamples(uint32_t *v, uint8_t n)
+    {
+        for (uint8_t i = 1; i < n; i++)
+        {
+            uint32_t x = v[i];
+            uint8_t j = i;
+            for (; j > 0 && v[j - 1] > x; j--)
+                v[j] = v[j - 1];
+            v[j] = x;
+        }
+    }
+
+    static bool onReply(const HC15Frame &frame, void *ctx)
+    {
+        HC15ProbeInitiator *self = static_cast<HC15ProbeInitiator *>(ctx);
+        if (frame.len < 2 || frame.src != self->peer_)
+            return false;
+        HC15_PROBE_OP op = static_cast<HC15_PROBE_OP>(frame.payload[0]);
+        if (op != HC15_PROBE_OP::ECHO_REP && op != HC15_PROBE_OP::BULK_REPORT && op != HC15_PROBE_OP::SPEED_ACK)
+            return false;
+        Reply rep;
+        rep.op = frame.payload[0];
+        size_t n = static_cast<size_t>(frame.len - 1) < sizeof(rep.data) ? frame.len - 1 : sizeof(rep.data);
+        memset(rep.data, 0, sizeof(rep.data));
+        memcpy(rep.data, frame.payload + 1, n);
+        rep.rx_us = frame.rx_last_us ? frame.rx_last_us : esp_timer_get_time();
+        xQueueSend(self->replies_, &rep, 0);
+        return true;
+    }
+
+    HC15Link *link_ = nullptr;
+    HC15 *hc15_ = nullptr;
+    uint16_t peer_ = 0;
+    QueueHandle_t replies_ = nullptr;
+    uint16_t echo_id_ = 0;
+    uint8_t run_ = 0;
+};
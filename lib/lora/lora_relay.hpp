@@ -0,0 +1,172 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_link.hpp>
+
+/*
+ * Flood-routing relay.
+ *
+ * Frames carrying HC15_FLAG_RELAY are rebroadcast by every relay node with the hop count in FLAGS
+ * decremented, after a random delay so neighbouring relays do not collide. src + seq of the
+ * originator are kept, which makes them a network-wide key for duplicate suppression.
+ */
+
+#ifndef HC15_RELAY_CACHE_SLOTS
+#define HC15_RELAY_CACHE_SLOTS 64 // 最近见过的 src+seq，须为 2 的幂
+#endif
+
+#ifndef HC15_RELAY_PENDING
+#define HC15_RELAY_PENDING 4 // 等待转发的帧数
+#endif
+
+#ifndef HC15_RELAY_MAX_DELAY_MS
+#define HC15_RELAY_MAX_DELAY_MS 200 // 随机转发延时上限
+#endif
+
+/*
+ * Fixed-size set of recently seen keys: 4-way set associative, round-robin replacement.
+ * Lookup and insert touch one 16-byte set, no heap. Old keys are forgotten, never wrongly reported.
+ */
+template <uint16_t SLOTS = HC15_RELAY_CACHE_SLOTS>
+class HC15RecentCache
+{
+    static_assert(SLOTS >= 4 && (SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of two >= 4");
+
+public:
+    HC15RecentCache()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (uint16_t i = 0; i < SLOTS; i++)
+            keys_[i] = EMPTY;
+        memset(victim_, 0, sizeof(victim_));
+    }
+
+    /*
+     * @brief Record a key.
+     * @return true if the key was already in the cache (duplicate).
+     */
+    bool checkAndInsert(uint32_t key)
+    {
+        uint16_t set = static_cast<uint16_t>((key * 2654435761u) >> 16) & (SETS - 1);
+        uint32_t *ways = keys_ + set * WAYS;
+        for (uint8_t w = 0; w < WAYS; w++)
+        {
+            if (ways[w] == key)
+                return true;
+        }
+        ways[victim_[set]] = key;
+        victim_[set] = (victim_[set] + 1) & (WAYS - 1);
+        return false;
+    }
+
+    static uint32_t key(uint16_t src, uint16_t seq)
+    {
+        return (static_cast<uint32_t>(src) << 16) | seq;
+    }
+
+private:
+    static const uint8_t WAYS = 4;
+    static const uint16_t SETS = SLOTS / WAYS;
+    static const uint32_t EMPTY = 0xFFFFFFFF; // src 0xFFFF 是广播地址，不会出现
+
+    uint32_t keys_[SLOTS];
+    uint8_t victim_[SETS];
+};
+
+class HC15Relay
+{
+public:
+    HC15Relay(HC15Link *link, uint16_t max_delay_ms = HC15_RELAY_MAX_DELAY_MS) : link_(link), max_delay_ms_(max_delay_ms)
+    {
+        pending_ = xQueueCreate(HC15_RELAY_PENDING, sizeof(Pending));
+    }
+
+    /*
+     * @brief Put the link into promiscuous mode and start inspecting every frame.
+     *        Run relayTask() in its own task to actually forward.
+     */
+    bool begin()
+    {
+        if (!link_ || !pending_)
+            return false;
+        link_->setPromiscuous(true);
+        link_->setForwardHook(&HC15Relay::onFrame, this);
+        return true;
+    }
+
+    /*
+     * @brief Forward queued frames once their random delay has expired, use rtos task please.
+     */
+    void relayTask(void * /*pvParameters*/)
+    {
+        Pending item;
+        uint8_t wire[HC15_FRAME_MAX_WIRE];
+        for (;;)
+        {
+            if (xQueueReceive(pending_, &item, portMAX_DELAY) != pdTRUE)
+                continue;
+            int32_t wait = static_cast<int32_t>(item.due - xTaskGetTickCount());
+            if (wait > 0)
+                vTaskDelay(wait);
+
+            // 保留原始 src / seq，不能走 link_->encode()
+            size_t n = link_->encodeRaw(item.frame, wire, sizeof(wire));
+            if (n && link_->driver()->send(wire, n) == static_cast<int>(n))
+                forwarded_++;
+        }
+    }
+
+    uint32_t forwarded() const { return forwarded_; }
+    uint32_t duplicates() const { return duplicates_; }
+    uint32_t overflows() const { return overflows_; }
+
+private:
+    struct Pending
+    {
+        TickType_t due;
+        HC15Frame frame;
+    };
+
+    static bool onFrame(const HC15Frame &frame, void *ctx)
+    {
+        return static_cast<HC15Relay *>(ctx)->inspect(frame);
+    }
+
+    bool inspect(const HC15Frame &frame)
+    {
+        if (frame.src == link_->nodeId())
+            return true; // 自己发出去又被转回来的
+        if (!(frame.flags & HC15_FLAG_RELAY))
+            return false; // 单跳帧没有副本，不用去重
+
+        if (cache_.checkAndInsert(HC15RecentCache<>::key(frame.src, frame.seq)))
+        {
+            duplicates_++;
+            return true;
+        }
+
+        uint8_t hops = (frame.flags & HC15_FLAG_HOPS_MASK) >> HC15_FLAG_HOPS_SHIFT;
+        bool unicast_to_me = !(frame.flags & (HC15_FLAG_BCAST | HC15_FLAG_MCAST)) && frame.dst == link_->nodeId();
+        if (hops == 0 || unicast_to_me)
+            return false;
+
+        Pending item;
+        item.frame = frame;
+        item.frame.flags = (frame.flags & ~HC15_FLAG_HOPS_MASK) | ((hops - 1) << HC15_FLAG_HOPS_SHIFT);
+        item.due = xTaskGetTickCount() + pdMS_TO_TICKS(esp_random() % (max_delay_ms_ + 1u));
+        if (xQueueSend(pending_, &item, 0) != pdTRUE)
+            overflows_++;
+        return false; // 本地照常投递（是否发给本节点由 link 判断）
+    }
+
+    HC15Link *link_ = nullptr;
+    uint16_t max_delay_ms_ = HC15_RELAY_MAX_DELAY_MS;
+    QueueHandle_t pending_ = nullptr;
+    HC15RecentCache<> cache_;
+    uint32_t forwarded_ = 0;
+    uint32_t duplicates_ = 0;
+    uint32_t overflows_ = 0;
+};
@@ -0,0 +1,190 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Compile-time telemetry schemas packed into a bitstream.
+ *
+ * A schema is a list of field types; widths, ranges and scaling are template parameters, so
+ * encode() / decode() unroll into straight shift-and-mask code with no tables, reflection or heap.
+ * Fields are packed MSB first without padding, the message is BYTES = ceil(sum of widths / 8) long.
+ *
+ *   typedef HC15Schema<HC15Field<11, -400, 850, 10>, // 温度 -40.0 ~ 85.0 ℃，0.1 精度
+ *                      HC15Field<7, 0, 100>,         // 湿度 %
+ *                      HC15UintField<12>,            // 电池 mV / 2
+ *                      HC15FlagField> Telemetry;     // 门磁
+ *   uint8_t buf[Telemetry::BYTES];                   // 4 字节，文本行约 20 字节
+ *   Telemetry::encode(buf, 23.4f, 56, 1870, true);
+ *   Telemetry::decode(buf, sizeof(buf), t, h, mv, door);
+ */
+
+/*
+ * MSB-first bit packer over a zeroed buffer.
+ */
+class HC15BitWriter
+{
+public:
+    explicit HC15BitWriter(uint8_t *out) : out_(out) {}
+
+    void put(uint32_t value, uint8_t bits)
+    {
+        while (bits)
+        {
+            uint8_t room = 8 - (pos_ & 7);
+            uint8_t n = bits < room ? bits : room;
+            uint8_t chunk = static_cast<uint8_t>((value >> (bits - n)) & ((1u << n) - 1));
+            out_[pos_ >> 3] |= static_cast<uint8_t>(chunk << (room - n));
+            pos_ += n;
+            bits -= n;
+        }
+    }
+
+private:
+    uint8_t *out_;
+    uint16_t pos_ = 0;
+};
+
+/*
+ * MSB-first bit reader, refills a 64-bit accumulator a byte at a time so each field is one shift.
+ */
+class HC15BitReader
+{
+public:
+    HC15BitReader(const uint8_t *in, size_t len) : in_(in), len_(len) {}
+
+    uint32_t get(uint8_t bits)
+    {
+        while (avail_ < bits)
+        {
+            acc_ = (acc_ << 8) | (pos_ < len_ ? in_[pos_] : 0);
+            pos_++;
+            avail_ += 8;
+        }
+        avail_ -= bits;
+        return static_cast<uint32_t>((acc_ >> avail_) & ((bits == 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1)));
+    }
+
+private:
+    const uint8_t *in_;
+    size_t len_;
+    size_t pos_ = 0;
+    uint64_t acc_ = 0;
+    uint8_t avail_ = 0;
+};
+
+/*
+ * @brief Scaled value: round(v * SCALE / SCALE_DEN) clamped to [MIN, MAX], sent as the offset from MIN.
+ *        The scale is a ratio so fractional scales can be written, e.g. <8, 0, 200, 1, 2> stores
+ *        0 ~ 400 in steps of 2. NaN (a failed sensor read) packs as MIN.
+ */
+template <uint8_t BITS_, int32_t MIN, int32_t MAX, uint32_t SCALE = 1, uint32_t SCALE_DEN = 1>
+struct HC15Field
+{
+    static_assert(BITS_ >= 1 && BITS_ <= 32, "field width must be 1..32 bits");
+    static_assert(MAX > MIN && SCALE > 0 && SCALE_DEN > 0, "empty range or zero scale");
+    static_assert(static_cast<uint64_t>(static_cast<int64_t>(MAX) - MIN) < (1ull << BITS_), "range does not fit in BITS");
+
+    static const uint8_t BITS = BITS_;
+    typedef float value_type;
+
+    static uint32_t pack(float v)
+    {
+        float q = v * SCALE / SCALE_DEN;
+        if (!(q > MIN))
+            return 0; // 也接住 NaN，不能让它进到 int64 转换
+        if (q >= MAX)
+            return static_cast<uint32_t>(static_cast<int64_t>(MAX) - MIN);
+        return static_cast<uint32_t>(static_cast<int64_t>(q + 0.5f - MIN)); // q > MIN，加 0.5 即四舍五入
+    }
+
+    static float unpack(uint32_t raw)
+    {
+        return static_cast<float>(static_cast<int64_t>(raw) + MIN) * SCALE_DEN / SCALE;
+    }
+};
+
+/*
+ * @brief Plain unsigned integer, saturates at 2^BITS - 1.
+ */
+template <uint8_t BITS_>
+struct HC15UintField
+{
+    static_assert(BITS_ >= 1 && BITS_ <= 32, "field width must be 1..32 bits");
+
+    static const uint8_t BITS = BITS_;
+    typedef uint32_t value_type;
+
+    static uint32_t pack(uint32_t v)
+    {
+        const uint32_t top = static_cast<uint32_t>((1ull << BITS_) - 1);
+        return v > top ? top : v;
+    }
+
+    static uint32_t unpack(uint32_t raw) { return raw; }
+};
+
+struct HC15FlagField
+{
+    static const uint8_t BITS = 1;
+    typedef bool value_type;
+
+    static uint32_t pack(bool v) { return v ? 1 : 0; }
+    static bool unpack(uint32_t raw) { return raw != 0; }
+};
+
+template <typename... Fields>
+struct HC15Schema;
+
+template <>
+struct HC15Schema<>
+{
+    static const uint16_t BITS = 0;
+
+    static void put(HC15BitWriter &) {}
+    static void get(HC15BitReader &) {}
+};
+
+template <typename F, typename... Rest>
+struct HC15Schema<F, Rest...>
+{
+    static const uint16_t BITS = F::BITS + HC15Schema<Rest...>::BITS;
+    static const uint16_t BYTES = (BITS + 7) / 8;
+
+    /*
+     * @brief Pack one value per field into out (at least BYTES long).
+     * @return BYTES.
+     */
+    static size_t encode(uint8_t *out, typename F::value_type v, typename Rest::value_type... rest)
+    {
+        memset(out, 0, BYTES);
+        HC15BitWriter w(out);
+        put(w, v, rest...);
+        return BYTES;
+    }
+
+    /*
+     * @brief Unpack a message into one variable per field.
+     * @return false if len is shorter than BYTES.
+     */
+    static bool decode(const uint8_t *in, size_t len, typename F::value_type &v, typename Rest::value_type &...rest)
+    {
+        if (len < BYTES)
+            return false;
+        HC15BitReader r(in, len);
+        get(r, v, rest...);
+        return true;
+    }
+
+    static void put(HC15BitWriter &w, typename F::value_type v, typename Rest::value_type... rest)
+    {
+        w.put(F::pack(v), F::BITS);
+        HC15Schema<Rest...>::put(w, rest...);
+    }
+
+    static void get(HC15BitReader &r, typename F::value_type &v, typename Rest::value_type &...rest)
+    {
+        v = F::unpack(r.get(F::BITS));
+        HC15Schema<Rest...>::get(r, rest...);
+    }
+};
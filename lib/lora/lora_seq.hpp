@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Per-peer receive sequence tracking: highest seq seen + 64-bit bitmap of the 64 seqs below it.
+ * The windows themselves live in HC15PeerTable (lora_peers.hpp).
+ */
+
+struct HC15SeqWindow
+{
+    uint16_t highest;
+    uint64_t bitmap; // bit i = highest - i 已收到
+
+    void reset(uint16_t seq)
+    {
+        highest = seq;
+        bitmap = 1;
+    }
+
+    /*
+     * @brief Check a received sequence number and mark it as seen.
+     * @param strict Reject seqs behind the window (authenticated frames, replay protection) instead
+     *        of taking them as a peer restart that re-bases the window.
+     * @return true if it is new, false if it is a duplicate.
+     */
+    bool accept(uint16_t seq, bool strict = false)
+    {
+        int16_t diff = static_cast<int16_t>(seq - highest);
+        if (diff > 0)
+        {
+            bitmap = (diff >= 64) ? 1 : ((bitmap << diff) | 1);
+            highest = seq;
+            return true;
+        }
+        uint16_t offset = static_cast<uint16_t>(-diff);
+        if (offset >= 64)
+        {
+            if (strict)
+                return false; // 认证帧靠 epoch 识别重启，太旧的一律当重放
+            reset(seq); // 对端重启，序号从头开始
+            return true;
+        }
+        uint64_t bit = 1ULL << offset;
+        if (bitmap & bit)
+            return false;
+        bitmap |= bit;
+        return true;
+    }
+};
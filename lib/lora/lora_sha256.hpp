@@ -0,0 +1,151 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#if defined(ESP_PLATFORM) && !defined(HC15_SHA256_PORTABLE)
+#include <mbedtls/sha256.h>
+#include <mbedtls/version.h>
+#define HC15_SHA256_MBEDTLS
+#endif
+
+/*
+ * Streaming SHA-256 with the return codes checked.
+ *
+ * On target it is mbedtls (hardware SHA on the ESP32-C3): the _ret calls on mbedtls 2.x, where the
+ * plain ones are deprecated, and the plain ones on 3.x, which dropped _ret and return int. Host
+ * builds (tools, tests) get a small portable implementation instead of a mbedtls dependency.
+ */
+class HC15Sha256
+{
+public:
+#ifdef HC15_SHA256_MBEDTLS
+    HC15Sha256() { mbedtls_sha256_init(&ctx_); }
+    ~HC15Sha256() { mbedtls_sha256_free(&ctx_); }
+#else
+    HC15Sha256() { starts(); }
+#endif
+    HC15Sha256(const HC15Sha256 &) = delete;
+    HC15Sha256 &operator=(const HC15Sha256 &) = delete;
+
+#ifdef HC15_SHA256_MBEDTLS
+#if MBEDTLS_VERSION_NUMBER < 0x03000000
+    bool starts() { return mbedtls_sha256_starts_ret(&ctx_, 0) == 0; }
+    bool update(const uint8_t *data, size_t len) { return mbedtls_sha256_update_ret(&ctx_, data, len) == 0; }
+    bool finish(uint8_t out[32]) { return mbedtls_sha256_finish_ret(&ctx_, out) == 0; }
+#else
+    bool starts() { return mbedtls_sha256_starts(&ctx_, 0) == 0; }
+    bool update(const uint8_t *data, size_t len) { return mbedtls_sha256_update(&ctx_, data, len) == 0; }
+    bool finish(uint8_t out[32]) { return mbedtls_sha256_finish(&ctx_, out) == 0; }
+#endif
+#else
+    bool starts()
+    {
+        static const uint32_t init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                         0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        memcpy(h_, init, sizeof(h_));
+        total_ = 0;
+        fill_ = 0;
+        return true;
+    }
+
+    bool update(const uint8_t *data, size_t len)
+    {
+        total_ += len;
+        while (len)
+        {
+            size_t n = 64 - fill_ < len ? 64 - fill_ : len;
+            memcpy(buf_ + fill_, data, n);
+            fill_ += n;
+            data += n;
+            len -= n;
+            if (fill_ == 64)
+            {
+                block(buf_);
+                fill_ = 0;
+            }
+        }
+        return true;
+    }
+
+    bool finish(uint8_t out[32])
+    {
+        uint64_t bits = total_ * 8;
+        uint8_t pad[72] = {0x80};
+        size_t n = (fill_ < 56 ? 56 : 120) - fill_; // 补到 56 mod 64，再放 64 位长度
+        for (int i = 0; i < 8; i++)
+            pad[n + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        update(pad, n + 8);
+        for (int i = 0; i < 8; i++)
+        {
+            for (int k = 0; k < 4; k++)
+                out[4 * i + k] = static_cast<uint8_t>(h_[i] >> (24 - 8 * k));
+        }
+        return true;
+    }
+#endif
+
+    /*
+     * @brief One-shot hash of a buffer.
+     */
+    static bool compute(const uint8_t *data, size_t len, uint8_t out[32])
+    {
+        HC15Sha256 sha;
+        return sha.starts() && sha.update(data, len) && sha.finish(out);
+    }
+
+private:
+#ifdef HC15_SHA256_MBEDTLS
+    mbedtls_sha256_context ctx_;
+#else
+    static uint32_t ror(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    void block(const uint8_t *p)
+    {
+        static const uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++)
+            w[i] = (static_cast<uint32_t>(p[4 * i]) << 24) | (p[4 * i + 1] << 16) | (p[4 * i + 2] << 8) | p[4 * i + 3];
+        for (int i = 16; i < 64; i++)
+        {
+            uint32_t s0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = h_[0], b = h_[1], c = h_[2], d = h_[3], e = h_[4], f = h_[5], g = h_[6], hh = h_[7];
+        for (int i = 0; i < 64; i++)
+        {
+            uint32_t t1 = hh + (ror(e, 6) ^ ror(e, 11) ^ ror(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+            uint32_t t2 = (ror(a, 2) ^ ror(a, 13) ^ ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        h_[0] += a;
+        h_[1] += b;
+        h_[2] += c;
+        h_[3] += d;
+        h_[4] += e;
+        h_[5] += f;
+        h_[6] += g;
+        h_[7] += hh;
+    }
+
+    uint32_t h_[8];
+    uint64_t total_ = 0;
+    uint8_t buf_[64];
+    size_t fill_ = 0;
+#endif
+};
@@ -0,0 +1,249 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_class.hpp>
+#include <lora_gpio.hpp>
+
+/*
+ * Compile-time specialised HC-15 driver for fixed boards.
+ *
+ * The UART, pins, buffer sizes and optional features are template parameters instead of members:
+ * STA / KEY become a single GPIO register load / store with a constant mask, the serial port is a
+ * known object so its calls devirtualise, and disabled metrics / logging compile to nothing.
+ * Binary (callback) receive only; for line mode and the link services use HC15.
+ *
+ *   struct Uart1 { static HardwareSerial &port() { return Serial1; } };
+ *   static HC15Static<Uart1, 12, 18> radio;
+ */
+
+/*
+ * @brief Defaults, derive and override what differs.
+ */
+struct HC15StaticConfig
+{
+    static const uint32_t BAUD = 115200;
+    static const int8_t RX_PIN = 1;
+    static const int8_t TX_PIN = 0;
+    static const uint32_t TIMEOUT_MS = 5000;
+    static const size_t RX_CHUNK = 128;    // monitorTask 单次搬运字节数
+    static const size_t RX_BUFFER = 1024;  // 驱动环形缓冲，须大于 FIFO 128
+    static const uint8_t RX_FIFO_FULL = 64; // 触发搬运的 FIFO 字节数，见 HC15::uartSettings()
+    static const uint8_t RX_TIMEOUT = 2;    // 线路空闲多少个字符时间触发搬运
+    static const bool METRICS = false;     // 收发字节 / 忙等计数
+    static const bool LOG = false;         // 调试输出，走 HC15_LOG（桥接模式下不输出）
+};
+
+template <bool ENABLED>
+struct HC15StaticMetrics
+{
+    uint32_t rx_bytes = 0;
+    uint32_t tx_bytes = 0;
+    uint32_t busy_waits = 0; // send() 遇到模块忙的次数
+
+    void rx(size_t n) { rx_bytes += n; }
+    void tx(size_t n) { tx_bytes += n; }
+    void busy() { busy_waits++; }
+};
+
+template <>
+struct HC15StaticMetrics<false>
+{
+    static const uint32_t rx_bytes = 0;
+    static const uint32_t tx_bytes = 0;
+    static const uint32_t busy_waits = 0;
+
+    void rx(size_t) {}
+    void tx(size_t) {}
+    void busy() {}
+};
+
+template <typename SerialPolicy, uint8_t STA_PIN, uint8_t KEY_PIN, typename Config = HC15StaticConfig>
+class HC15Static
+{
+public:
+    typedef HC15StaticPin<STA_PIN> Sta;
+    typedef HC15StaticPin<KEY_PIN> Key;
+
+    HC15Static()
+    {
+        hc15_buzy_semaphore_ = xSemaphoreCreateBinary();
+    }
+
+    bool begin(HC15RxCallback cb, void *ctx = nullptr)
+    {
+        if (!hc15_buzy_semaphore_)
+            return false;
+        rx_cb_ = cb;
+        rx_ctx_ = ctx;
+        SerialPolicy::port().end(); // 驱动已装好时 setRxBufferSize 会被拒绝
+        if (SerialPolicy::port().setRxBufferSize(Config::RX_BUFFER) != Config::RX_BUFFER)
+            log("RX buffer size not applied: %u", static_cast<unsigned>(Config::RX_BUFFER));
+        SerialPolicy::port().begin(Config::BAUD, SERIAL_8N1, Config::RX_PIN, Config::TX_PIN);
+        SerialPolicy::port().setRxFIFOFull(Config::RX_FIFO_FULL);
+        SerialPolicy::port().setRxTimeout(Config::RX_TIMEOUT);
+        pinMode(STA_PIN, INPUT_PULLDOWN); // 配置只做一次，之后只碰寄存器
+        pinMode(KEY_PIN, OUTPUT);
+        Key::high();
+        log("STA_PIN:%u, KEY_PIN:%u", STA_PIN, KEY_PIN);
+        SerialPolicy::port().flush();
+        xSemaphoreGive(hc15_buzy_semaphore_);
+        return true;
+    }
+
+    bool isBuzy() const
+    {
+        return !Sta::read(); // LOW means busy
+    }
+
+    /*
+     * @brief Read data from the HC-15 module, use rtos task please
+     */
+    void monitorTask(void *pvParameters)
+    {
+        uint32_t delay_ms = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pvParameters));
+        if (delay_ms == 0)
+            delay_ms = 200;
+
+        for (;;)
+        {
+            if (xSemaphoreTake(hc15_buzy_semaphore_, pdMS_TO_TICKS(5000)) == pdTRUE)
+            {
+                size_t got = 0;
+                if (!isBuzy() && SerialPolicy::port().available() > 0)
+                    got = SerialPolicy::port().read(rx_chunk_, sizeof(rx_chunk_));
+                xSemaphoreGive(hc15_buzy_semaphore_);
+
+                if (got > 0)
+                {
+                    metrics_.rx(got);
+                    if (rx_cb_)
+                        rx_cb_(rx_chunk_, got, rx_ctx_);
+                    if (got == sizeof(rx_chunk_))
+                        continue; // 还有剩余字节，不休眠直接再读
+                }
+            }
+            vTaskDelay(pdMS_TO_TICKS(delay_ms));
+        }
+    }
+
+    /*
+     * @brief Send raw bytes over the air in transparent mode, same contract as HC15::send().
+     */
+    int send(const uint8_t *data, size_t len, uint32_t timeout_ms = Config::TIMEOUT_MS)
+    {
+        if (!data || len == 0)
+            return 0;
+        if (xSemaphoreTake(hc15_buzy_semaphore_, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+            return 0;
+        uint32_t time1 = millis();
+        if (isBuzy())
+            metrics_.busy();
+        while (isBuzy() && millis() - time1 < timeout_ms)
+            vTaskDelay(1);
+        int written = isBuzy() ? 0 : SerialPolicy::port().write(data, len);
+        xSemaphoreGive(hc15_buzy_semaphore_);
+        metrics_.tx(written);
+        return written;
+    }
+
+    /*
+     * @brief Send an AT command and wait for the line starting with expect.
+     * @param reply Receives the text after expect (nul terminated), may be nullptr.
+     */
+    bool command(const char *cmd, const char *expect, char *reply = nullptr, size_t cap = 0,
+                 uint32_t timeout_ms = Config::TIMEOUT_MS)
+    {
+        if (xSemaphoreTake(hc15_buzy_semaphore_, pdMS_TO_TICKS(10000)) != pdTRUE)
+            return false;
+        bool ok = false;
+        Key::low();
+        if (HC15::commandReady([this]() { return isBuzy(); }, timeout_ms)) // 与 HC15::write() 同一判定
+        {
+            delay(100);
+            SerialPolicy::port().write(reinterpret_cast<const uint8_t *>(cmd), strlen(cmd));
+            char line[32];
+            size_t n = readLine(line, sizeof(line), timeout_ms);
+            size_t elen = strlen(expect);
+            ok = n >= elen && memcmp(line, expect, elen) == 0;
+            if (ok && reply && cap)
+            {
+                size_t rlen = n - elen < cap - 1 ? n - elen : cap - 1;
+                memcpy(reply, line + elen, rlen);
+                reply[rlen] = '\0';
+            }
+            if (!ok)
+                log("command %s failed, response: %s", cmd, line);
+        }
+        Key::high();
+        xSemaphoreGive(hc15_buzy_semaphore_);
+        return ok;
+    }
+
+    bool setChannel(uint8_t channel)
+    {
+        if (channel < 1 || channel > 50)
+            return false;
+        char cmd[12];
+        snprintf(cmd, sizeof(cmd), "AT+C%03u\r\n", channel);
+        return command(cmd, "OK+C:");
+    }
+
+    bool setSpeed(uint8_t speed)
+    {
+        if (speed < 1 || speed > 8)
+            return false;
+        char cmd[12];
+        snprintf(cmd, sizeof(cmd), "AT+S%03u\r\n", speed);
+        return command(cmd, "OK+S:");
+    }
+
+    uint32_t rxBytes() const { return metrics_.rx_bytes; }
+    uint32_t txBytes() const { return metrics_.tx_bytes; }
+    uint32_t busyWaits() const { return metrics_.busy_waits; }
+
+    SemaphoreHandle_t hc15_buzy_semaphore_ = nullptr;
+
+private:
+    /*
+     * @brief Read one CR/LF terminated line into buf, nul terminated.
+     * @return The line length without the terminator.
+     */
+    size_t readLine(char *buf, size_t cap, uint32_t timeout_ms)
+    {
+        size_t n = 0;
+        uint32_t time1 = millis();
+        while (millis() - time1 < timeout_ms)
+        {
+            int c = SerialPolicy::port().read();
+            if (c < 0)
+            {
+                vTaskDelay(1);
+                continue;
+            }
+            if (c == '\r' || c == '\n')
+            {
+                if (n)
+                    break;
+                continue;
+            }
+            if (n + 1 < cap)
+                buf[n++] = static_cast<char>(c);
+        }
+        buf[n] = '\0';
+        return n;
+    }
+
+    template <typename... Args>
+    static void log(const char *fmt, Args... args)
+    {
+        if (!Config::LOG)
+            return;
+        char line[96];
+        snprintf(line, sizeof(line), fmt, args...);
+        HC15_LOG(line); // 和 HC15 一样，桥接模式下 Serial 上不出文本
+    }
+
+    HC15RxCallback rx_cb_ = nullptr;
+    void *rx_ctx_ = nullptr;
+    uint8_t rx_chunk_[Config::RX_CHUNK];
+    HC15StaticMetrics<Config::METRICS> metrics_;
+};
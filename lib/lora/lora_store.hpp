@@ -0,0 +1,595 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <lora_link.hpp>
+
+/*
+ * Store-and-forward of outbound frames across link outages.
+ *
+ * HC15FlashRing is an append-only log over a raw data partition (add e.g.
+ * "hc15log, data, 0x40, , 256K" to the partition table). Sectors are used strictly in order and a
+ * sector is only erased when the head comes round to it again, so every sector sees the same number
+ * of erase cycles. When the ring is full the oldest sector is dropped; RAM use is a few counters no
+ * matter how long the outage lasts.
+ *
+ * sector: MAGIC(4) | SEQ(4) | records ...
+ * record: LEN(1) | STATE(1) | CRC16(2) | DATA(LEN), padded to 4 bytes
+ * STATE only ever clears bits: 0xFF written (torn if power fails here) -> 0x7E committed -> 0x00 sent.
+ */
+
+#ifndef HC15_STORE_BURST
+#define HC15_STORE_BURST 8 // 链路恢复后每批补发的帧数
+#endif
+
+#ifndef HC15_STORE_GAP_MS
+#define HC15_STORE_GAP_MS 50 // 批内帧间隔
+#endif
+
+#ifndef HC15_STORE_PAUSE_MS
+#define HC15_STORE_PAUSE_MS 2000 // 批间隔，给实时数据留出空中时间
+#endif
+
+#ifndef HC15_STORE_PEER_TIMEOUT_MS
+#define HC15_STORE_PEER_TIMEOUT_MS 60000 // 超过这么久没听到对端，视为链路断开
+#endif
+
+#ifndef HC15_STORE_DESTS
+#define HC15_STORE_DESTS 16 // 分别跟踪积压的目的地个数，超出后未知目的地一律先入队
+#endif
+
+#define HC15_STORE_SECTOR 4096
+#define HC15_STORE_MAGIC 0x53314348 // "HC1S"
+#define HC15_STORE_SECTOR_HEADER 8
+#define HC15_STORE_RECORD_HEADER 4
+#define HC15_STORE_MAX_RECORD 0xFE
+
+/*
+ * @brief Position of a walk over the ring, see HC15FlashRing::next().
+ */
+struct HC15RingCursor
+{
+    uint16_t sector = 0;
+    uint32_t off = 0;
+    uint32_t seq = 0;  // 扇区被 head 绕回擦掉后 SEQ 会变
+    uint32_t at = 0;   // next() 返回的记录地址
+    bool lost = false; // 走到一半所在扇区被丢弃了
+};
+
+class HC15FlashRing
+{
+public:
+    /*
+     * @param label Name of a data partition of at least two sectors.
+     */
+    explicit HC15FlashRing(const char *label) : label_(label)
+    {
+        lock_ = xSemaphoreCreateMutex();
+    }
+
+    /*
+     * @brief Find the partition and recover head / tail from the sector headers.
+     */
+    bool begin()
+    {
+        part_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label_);
+        if (!part_ || !lock_)
+            return false;
+        sectors_ = part_->size / HC15_STORE_SECTOR;
+        if (sectors_ < 2)
+            return false;
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        bool ok = mount();
+        xSemaphoreGive(lock_);
+        return ok;
+    }
+
+    /*
+     * @brief Append one record, dropping the oldest sector if the ring is full.
+     */
+    bool push(const uint8_t *data, size_t len)
+    {
+        if (!part_ || len == 0 || len > HC15_STORE_MAX_RECORD)
+            return false;
+        size_t need = align(HC15_STORE_RECORD_HEADER + len);
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        bool ok = true;
+        if (head_off_ + need > HC15_STORE_SECTOR)
+            ok = advanceHead();
+        if (ok)
+        {
+            uint32_t at = addr(head_sector_, head_off_);
+            uint8_t hdr[HC15_STORE_RECORD_HEADER] = {static_cast<uint8_t>(len), STATE_WRITTEN, 0, 0};
+            HC15FrameCodec::put16(hdr + 2, HC15FrameCodec::crc16(data, len));
+            // 先写头（LEN 占位），掉电时 mount 能按 LEN 跳过这条残缺记录
+            ok = esp_partition_write(part_, at, hdr, sizeof(hdr)) == ESP_OK &&
+                 esp_partition_write(part_, at + HC15_STORE_RECORD_HEADER, data, len) == ESP_OK &&
+                 setState(at, STATE_COMMITTED);
+            head_off_ += need; // 写失败也跳过这块，不在坏位置上反复写
+            if (ok)
+                pending_++;
+        }
+        xSemaphoreGive(lock_);
+        return ok;
+    }
+
+    /*
+     * @brief Copy the oldest unsent record into out without removing it.
+     * @return Its length, 0 if the ring is empty.
+     */
+    size_t peek(uint8_t *out, size_t cap)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        size_t n = 0;
+        while (pending_ && n == 0)
+        {
+            uint8_t hdr[HC15_STORE_RECORD_HEADER];
+            if (!nextRecord(hdr))
+                break;
+            uint32_t at = addr(tail_sector_, tail_off_);
+            size_t len = hdr[0];
+            if (hdr[1] == STATE_COMMITTED && len <= cap &&
+                esp_partition_read(part_, at + HC15_STORE_RECORD_HEADER, out, len) == ESP_OK &&
+                HC15FrameCodec::crc16(out, len) == HC15FrameCodec::get16(hdr + 2))
+            {
+                n = len;
+                break;
+            }
+            if (hdr[1] == STATE_COMMITTED)
+            {
+                setState(at, STATE_SENT); // 校验失败的记录丢掉
+                pending_--;
+                corrupt_++;
+            }
+            tail_off_ += align(HC15_STORE_RECORD_HEADER + len);
+        }
+        xSemaphoreGive(lock_);
+        return n;
+    }
+
+    /*
+     * @brief Mark the record returned by peek() as sent.
+     */
+    void pop()
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        uint8_t hdr[HC15_STORE_RECORD_HEADER];
+        if (pending_ && nextRecord(hdr) && hdr[1] == STATE_COMMITTED)
+        {
+            setState(addr(tail_sector_, tail_off_), STATE_SENT);
+            tail_off_ += align(HC15_STORE_RECORD_HEADER + hdr[0]);
+            pending_--;
+        }
+        xSemaphoreGive(lock_);
+    }
+
+    /*
+     * @brief Start a walk at the oldest record.
+     */
+    void rewind(HC15RingCursor &c)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        c.sector = tail_sector_;
+        c.off = tail_off_;
+        c.at = 0;
+        c.lost = !readHeader(c.sector, c.seq);
+        xSemaphoreGive(lock_);
+    }
+
+    /*
+     * @brief Copy the next unsent record after the cursor into out, records can then be marked
+     *        sent out of order with markSent().
+     * @return Its length, 0 at the head or if the cursor's sector was dropped meanwhile (c.lost).
+     */
+    size_t next(HC15RingCursor &c, uint8_t *out, size_t cap)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        size_t n = 0;
+        uint32_t seq;
+        if (!part_ || c.lost || !readHeader(c.sector, seq) || seq != c.seq)
+            c.lost = true;
+        while (!c.lost && n == 0)
+        {
+            if (c.sector == head_sector_ && c.off >= head_off_)
+                break;
+            uint8_t hdr[HC15_STORE_RECORD_HEADER];
+            if (c.off + HC15_STORE_RECORD_HEADER > HC15_STORE_SECTOR ||
+                esp_partition_read(part_, addr(c.sector, c.off), hdr, sizeof(hdr)) != ESP_OK ||
+                hdr[0] == LEN_ERASED || hdr[0] == 0)
+            {
+                if (c.sector == head_sector_)
+                    break;
+                c.sector = next(c.sector);
+                c.off = HC15_STORE_SECTOR_HEADER;
+                c.lost = !readHeader(c.sector, c.seq);
+                continue;
+            }
+            uint32_t at = addr(c.sector, c.off);
+            size_t len = hdr[0];
+            c.off += align(HC15_STORE_RECORD_HEADER + len);
+            if (hdr[1] != STATE_COMMITTED)
+                continue;
+            if (len <= cap && esp_partition_read(part_, at + HC15_STORE_RECORD_HEADER, out, len) == ESP_OK &&
+                HC15FrameCodec::crc16(out, len) == HC15FrameCodec::get16(hdr + 2))
+            {
+                c.at = at;
+                n = len;
+            }
+            else
+            {
+                setState(at, STATE_SENT); // 校验失败的记录丢掉
+                pending_--;
+                corrupt_++;
+            }
+        }
+        xSemaphoreGive(lock_);
+        return n;
+    }
+
+    /*
+     * @brief Mark the record last returned by next() as sent, the tail skips over sent records.
+     */
+    bool markSent(const HC15RingCursor &c)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        uint32_t seq;
+        uint8_t hdr[HC15_STORE_RECORD_HEADER];
+        bool ok = !c.lost && c.at && readHeader(c.sector, seq) && seq == c.seq &&
+                  esp_partition_read(part_, c.at, hdr, sizeof(hdr)) == ESP_OK && hdr[1] == STATE_COMMITTED &&
+                  setState(c.at, STATE_SENT);
+        if (ok)
+        {
+            pending_--;
+            while (nextRecord(hdr) && hdr[1] != STATE_COMMITTED)
+                tail_off_ += align(HC15_STORE_RECORD_HEADER + hdr[0]); // tail 越过已发的前缀
+        }
+        xSemaphoreGive(lock_);
+        return ok;
+    }
+
+    uint32_t pending() const { return pending_; }
+    bool empty() const { return pending_ == 0; }
+    uint32_t dropped() const { return dropped_; }
+    uint32_t corrupt() const { return corrupt_; }
+
+private:
+    static const uint8_t STATE_WRITTEN = 0xFF;
+    static const uint8_t STATE_COMMITTED = 0x7E;
+    static const uint8_t STATE_SENT = 0x00;
+    static const uint8_t LEN_ERASED = 0xFF;
+
+    static size_t align(size_t n) { return (n + 3) & ~static_cast<size_t>(3); }
+
+    uint32_t addr(uint16_t sector, uint32_t off) const
+    {
+        return static_cast<uint32_t>(sector) * HC15_STORE_SECTOR + off;
+    }
+
+    uint16_t next(uint16_t sector) const { return (sector + 1) % sectors_; }
+
+    bool setState(uint32_t at, uint8_t state)
+    {
+        return esp_partition_write(part_, at + 1, &state, 1) == ESP_OK;
+    }
+
+    bool readHeader(uint16_t sector, uint32_t &seq)
+    {
+        uint32_t hdr[2];
+        if (esp_partition_read(part_, addr(sector, 0), hdr, sizeof(hdr)) != ESP_OK || hdr[0] != HC15_STORE_MAGIC)
+            return false;
+        seq = hdr[1];
+        return true;
+    }
+
+    bool startSector(uint16_t sector, uint32_t seq)
+    {
+        uint32_t hdr[2] = {HC15_STORE_MAGIC, seq};
+        return esp_partition_erase_range(part_, addr(sector, 0), HC15_STORE_SECTOR) == ESP_OK &&
+               esp_partition_write(part_, addr(sector, 0), hdr, sizeof(hdr)) == ESP_OK;
+    }
+
+    /*
+     * @brief Read the record header at the tail, moving the tail on to the next sector at a sector end.
+     * @return false if there is nothing left before the head.
+     */
+    bool nextRecord(uint8_t hdr[HC15_STORE_RECORD_HEADER])
+    {
+        for (;;)
+        {
+            if (tail_sector_ == head_sector_ && tail_off_ >= head_off_)
+                return false;
+            if (tail_off_ + HC15_STORE_RECORD_HEADER <= HC15_STORE_SECTOR &&
+                esp_partition_read(part_, addr(tail_sector_, tail_off_), hdr, HC15_STORE_RECORD_HEADER) == ESP_OK &&
+                hdr[0] != LEN_ERASED && hdr[0] != 0)
+                return true;
+            if (tail_sector_ == head_sector_)
+                return false;
+            tail_sector_ = next(tail_sector_); // 本扇区读完，旧扇区等 head 绕回来时再擦
+            tail_off_ = HC15_STORE_SECTOR_HEADER;
+        }
+    }
+
+    /*
+     * @brief Move the head to the next sector, dropping the oldest sector if the ring is full.
+     */
+    bool advanceHead()
+    {
+        uint16_t n = next(head_sector_);
+        if (n == tail_sector_)
+        {
+            // 满了：丢掉最旧扇区里还没发的记录
+            uint32_t off = tail_off_;
+            while (off + HC15_STORE_RECORD_HEADER <= HC15_STORE_SECTOR)
+            {
+                uint8_t hdr[HC15_STORE_RECORD_HEADER];
+                if (esp_partition_read(part_, addr(n, off), hdr, sizeof(hdr)) != ESP_OK || hdr[0] == LEN_ERASED || hdr[0] == 0)
+                    break;
+                if (hdr[1] == STATE_COMMITTED && pending_)
+                {
+                    pending_--;
+                    dropped_++;
+                }
+                off += align(HC15_STORE_RECORD_HEADER + hdr[0]);
+            }
+            tail_sector_ = next(n);
+            tail_off_ = HC15_STORE_SECTOR_HEADER;
+        }
+        if (!startSector(n, ++head_seq_))
+            return false;
+        head_sector_ = n;
+        head_off_ = HC15_STORE_SECTOR_HEADER;
+        return true;
+    }
+
+    /*
+     * @brief Rebuild head, tail and the pending count: the head is the sector with the newest SEQ, the
+     *        tail the oldest sector of the unbroken SEQ chain behind it.
+     */
+    bool mount()
+    {
+        bool found = false;
+        uint32_t seq = 0;
+        for (uint16_t s = 0; s < sectors_; s++)
+        {
+            uint32_t q;
+            if (readHeader(s, q) && (!found || static_cast<int32_t>(q - head_seq_) > 0))
+            {
+                found = true;
+                head_sector_ = s;
+                head_seq_ = q;
+            }
+        }
+        if (!found)
+        {
+            head_sector_ = tail_sector_ = 0;
+            head_seq_ = 1;
+            head_off_ = tail_off_ = HC15_STORE_SECTOR_HEADER;
+            pending_ = 0;
+            return startSector(0, head_seq_);
+        }
+
+        tail_sector_ = head_sector_;
+        for (uint16_t i = 1; i < sectors_; i++)
+        {
+            uint16_t prev = (head_sector_ + sectors_ - i) % sectors_;
+            if (!readHeader(prev, seq) || seq != head_seq_ - i)
+                break;
+            tail_sector_ = prev;
+        }
+
+        // 从 tail 扫到 head：统计未发记录，找到写入位置
+        pending_ = 0;
+        for (uint16_t s = tail_sector_;; s = next(s))
+        {
+            uint32_t off = HC15_STORE_SECTOR_HEADER;
+            while (off + HC15_STORE_RECORD_HEADER <= HC15_STORE_SECTOR)
+            {
+                uint8_t hdr[HC15_STORE_RECORD_HEADER];
+                if (esp_partition_read(part_, addr(s, off), hdr, sizeof(hdr)) != ESP_OK || hdr[0] == LEN_ERASED || hdr[0] == 0)
+                    break;
+                if (hdr[1] == STATE_COMMITTED)
+                    pending_++;
+                off += align(HC15_STORE_RECORD_HEADER + hdr[0]); // 写了一半的记录（STATE 0xFF）直接跳过
+            }
+            if (s == head_sector_)
+            {
+                head_off_ = off;
+                break;
+            }
+        }
+        tail_off_ = HC15_STORE_SECTOR_HEADER;
+        return true;
+    }
+
+    const char *label_ = nullptr;
+    const esp_partition_t *part_ = nullptr;
+    SemaphoreHandle_t lock_ = nullptr;
+    uint16_t sectors_ = 0;
+    uint16_t head_sector_ = 0;
+    uint32_t head_off_ = HC15_STORE_SECTOR_HEADER;
+    uint32_t head_seq_ = 0;
+    uint16_t tail_sector_ = 0;
+    uint32_t tail_off_ = HC15_STORE_SECTOR_HEADER;
+    uint32_t pending_ = 0;
+    uint32_t dropped_ = 0;
+    uint32_t corrupt_ = 0;
+};
+
+/*
+ * Sends directly while the peer is reachable, diverts to the flash ring while it is not (or the
+ * send fails) and drains the ring in paced bursts once it is heard from again. Order is kept per
+ * destination: while anything is stored for a destination, new frames to it queue behind it, and
+ * records for a destination that is unreachable are skipped rather than waited on, so one silent
+ * peer does not hold up the others. Up to HC15_STORE_DESTS destinations are tracked; beyond that
+ * (and after a reboot until the first full pass) every frame is queued.
+ */
+class HC15StoreForward
+{
+public:
+    HC15StoreForward(HC15Link *link, HC15FlashRing *ring) : link_(link), ring_(ring)
+    {
+        lock_ = xSemaphoreCreateMutex();
+    }
+
+    /*
+     * @brief A peer counts as reachable if a frame from it arrived within timeout_ms.
+     */
+    void setPeerTimeout(uint32_t timeout_ms) { peer_timeout_ms_ = timeout_ms; }
+
+    /*
+     * @return false only if the frame could neither be sent nor stored.
+     */
+    bool send(uint16_t dst, uint8_t port, const uint8_t *payload, uint8_t len)
+    {
+        if (len > HC15_FRAME_MAX_PAYLOAD || (len && !payload))
+            return false;
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        bool direct = !queued(dst);
+        xSemaphoreGive(lock_);
+        if (direct && reachable(dst) && link_->sendPort(dst, port, payload, len))
+            return true;
+        uint8_t rec[3 + HC15_FRAME_MAX_PAYLOAD];
+        HC15FrameCodec::put16(rec, dst);
+        rec[2] = port;
+        memcpy(rec + 3, payload, len);
+        xSemaphoreTake(lock_, portMAX_DELAY); // 入队和计数一起做，flushTask 的重新统计不会漏掉它
+        bool ok = ring_->push(rec, 3 + len);
+        if (ok)
+            count(dests_, ndests_, known_, dst, 1);
+        xSemaphoreGive(lock_);
+        if (!ok)
+            return false;
+        stored_++;
+        return true;
+    }
+
+    /*
+     * @brief Drain the ring for the reachable peers, use rtos task please.
+     *        Each pass walks the whole ring: it sends up to HC15_STORE_BURST records, skips every
+     *        destination that is unreachable or whose send failed (its later records wait too, so
+     *        order holds), and recounts what is left per destination.
+     */
+    void flushTask(void * /*pvParameters*/)
+    {
+        uint8_t rec[3 + HC15_FRAME_MAX_PAYLOAD];
+        for (;;)
+        {
+            uint8_t burst = 0;
+            uint16_t blocked[HC15_STORE_DESTS];
+            uint8_t nblocked = 0;
+            bool block_all = false; // 跳过的目的地记不下了，本轮剩下的都不发
+            Dest left[HC15_STORE_DESTS];
+            uint8_t nleft = 0;
+            bool complete = true;
+
+            HC15RingCursor c;
+            ring_->rewind(c);
+            for (;;)
+            {
+                xSemaphoreTake(lock_, portMAX_DELAY);
+                size_t n = ring_->next(c, rec, sizeof(rec));
+                if (n < 3)
+                {
+                    if (!c.lost)
+                    {
+                        // 走到 head：用本轮的统计替换计数（send 入队也持有 lock_，不会漏）
+                        memcpy(dests_, left, sizeof(Dest) * nleft);
+                        ndests_ = nleft;
+                        known_ = complete;
+                    }
+                    xSemaphoreGive(lock_);
+                    break;
+                }
+                xSemaphoreGive(lock_);
+
+                uint16_t dst = HC15FrameCodec::get16(rec);
+                bool skip = block_all || burst >= HC15_STORE_BURST;
+                for (uint8_t i = 0; i < nblocked && !skip; i++)
+                    skip = blocked[i] == dst;
+                if (!skip && reachable(dst) && link_->sendPort(dst, rec[2], rec + 3, static_cast<uint8_t>(n - 3)))
+                {
+                    xSemaphoreTake(lock_, portMAX_DELAY);
+                    if (ring_->markSent(c))
+                        count(dests_, ndests_, known_, dst, -1);
+                    xSemaphoreGive(lock_);
+                    flushed_++;
+                    burst++;
+                    vTaskDelay(pdMS_TO_TICKS(HC15_STORE_GAP_MS));
+                    continue;
+                }
+                if (!skip)
+                {
+                    if (nblocked < HC15_STORE_DESTS)
+                        blocked[nblocked++] = dst;
+                    else
+                        block_all = true;
+                }
+                count(left, nleft, complete, dst, 1);
+            }
+            vTaskDelay(pdMS_TO_TICKS(HC15_STORE_PAUSE_MS));
+        }
+    }
+
+    uint32_t stored() const { return stored_; }
+    uint32_t flushed() const { return flushed_; }
+
+private:
+    struct Dest
+    {
+        uint16_t dst;
+        uint32_t stored; // 环里还没发的条数
+    };
+
+    /*
+     * @brief Whether frames to dst must queue behind stored ones, lock_ held.
+     */
+    bool queued(uint16_t dst)
+    {
+        if (ring_->empty())
+        {
+            ndests_ = 0; // 全发完了，计数归零
+            known_ = true;
+            return false;
+        }
+        for (uint8_t i = 0; i < ndests_; i++)
+        {
+            if (dests_[i].dst == dst)
+                return dests_[i].stored > 0;
+        }
+        return !known_; // 没有完整统计时保守处理
+    }
+
+    static void count(Dest *table, uint8_t &n, bool &complete, uint16_t dst, int32_t delta)
+    {
+        for (uint8_t i = 0; i < n; i++)
+        {
+            if (table[i].dst == dst)
+            {
+                if (delta > 0 || table[i].stored)
+                    table[i].stored += delta;
+                return;
+            }
+        }
+        if (delta <= 0)
+            return;
+        if (n < HC15_STORE_DESTS)
+            table[n++] = {dst, static_cast<uint32_t>(delta)};
+        else
+            complete = false;
+    }
+
+    bool reachable(uint16_t dst)
+    {
+        uint32_t seen;
+        return link_->lastHeard(dst, seen) && millis() - seen <= peer_timeout_ms_;
+    }
+
+    HC15Link *link_ = nullptr;
+    HC15FlashRing *ring_ = nullptr;
+    SemaphoreHandle_t lock_ = nullptr;
+    Dest dests_[HC15_STORE_DESTS];
+    uint8_t ndests_ = 0;
+    bool known_ = false; // 重启后环里可能有旧记录，第一轮走完之前不知道各目的地的积压
+    uint32_t peer_timeout_ms_ = HC15_STORE_PEER_TIMEOUT_MS;
+    uint32_t stored_ = 0;
+    uint32_t flushed_ = 0;
+};
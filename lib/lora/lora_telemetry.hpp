@@ -0,0 +1,393 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_link.hpp>
+
+/*
+ * Report-by-exception telemetry for slowly changing sensor channels.
+ *
+ * The node sends a KEYFRAME with every channel, the gateway acknowledges it (TELEM_ACK). After that
+ * a channel is only reported when it moves more than its deadband away from the value last reported,
+ * as a small zigzag varint delta against the acknowledged keyframe, so each DELTA decodes on its own
+ * and a lost one does not corrupt the following ones. Deltas are not acknowledged: the channels of
+ * the last delta are sent again HC15_TELEM_DELTA_REPEATS times, HC15_TELEM_REPEAT_MS apart, so one
+ * lost on air does not leave the gateway stale until the next keyframe. A keyframe is repeated every
+ * keyframe interval for resync. Quiet sensors send nothing else between keyframes.
+ *
+ * payload (DATA on the telemetry port):
+ *   KEYFRAME: 0x80 | id(7 bits) | value varint x CHANNELS
+ *   DELTA:           id(7 bits) | changed mask (ceil(CHANNELS / 8) bytes, LSB = channel 0) | delta varint x changed
+ */
+
+#ifndef HC15_TELEM_PORT
+#define HC15_TELEM_PORT 2
+#endif
+
+#ifndef HC15_TELEM_KEYFRAME_MS
+#define HC15_TELEM_KEYFRAME_MS 600000 // 默认 10 分钟一帧全量
+#endif
+
+#ifndef HC15_TELEM_ACK_TIMEOUT_MS
+#define HC15_TELEM_ACK_TIMEOUT_MS 5000 // 关键帧未确认时的重发间隔
+#endif
+
+#ifndef HC15_TELEM_REPEAT_MS
+#define HC15_TELEM_REPEAT_MS 30000 // 差分无确认，隔多久把上次变化的通道再发一遍
+#endif
+
+#ifndef HC15_TELEM_DELTA_REPEATS
+#define HC15_TELEM_DELTA_REPEATS 1 // 每个差分额外重发的次数，0 = 不重发
+#endif
+
+#ifndef HC15_TELEM_KEYFRAMES
+#define HC15_TELEM_KEYFRAMES 4 // 接收端保留的关键帧个数，须 >= 2
+#endif
+
+#define HC15_TELEM_KEYFRAME_BIT 0x80
+
+class HC15Varint
+{
+public:
+    static uint8_t *put(uint8_t *p, int32_t v)
+    {
+        uint32_t z = (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+        while (z >= 0x80)
+        {
+            *p++ = static_cast<uint8_t>(z | 0x80);
+            z >>= 7;
+        }
+        *p++ = static_cast<uint8_t>(z);
+        return p;
+    }
+
+    /*
+     * @return The position after the varint, or nullptr if it runs past end.
+     */
+    static const uint8_t *get(const uint8_t *p, const uint8_t *end, int32_t &v)
+    {
+        uint32_t z = 0;
+        for (uint8_t shift = 0; p < end && shift < 35; shift += 7)
+        {
+            uint8_t c = *p++;
+            z |= static_cast<uint32_t>(c & 0x7F) << shift;
+            if (!(c & 0x80))
+            {
+                v = static_cast<int32_t>(z >> 1) ^ -static_cast<int32_t>(z & 1);
+                return p;
+            }
+        }
+        return nullptr;
+    }
+};
+
+template <uint8_t CHANNELS>
+class HC15TelemetryEncoder
+{
+    static_assert(CHANNELS >= 1 && CHANNELS <= 32, "1..32 channels");
+
+public:
+    static const uint8_t MASK_BYTES = (CHANNELS + 7) / 8;
+    static const uint8_t MAX_LEN = 1 + MASK_BYTES + 5 * CHANNELS;
+    static_assert(MAX_LEN <= HC15_FRAME_MAX_PAYLOAD, "too many channels for one frame");
+
+    HC15TelemetryEncoder(HC15Link *link, uint16_t dst, uint8_t port = HC15_TELEM_PORT) : link_(link), dst_(dst), port_(port)
+    {
+        lock_ = xSemaphoreCreateMutex();
+        memset(deadband_, 0, sizeof(deadband_));
+    }
+
+    bool begin()
+    {
+        if (!link_ || !lock_)
+            return false;
+        return link_->addHandler(HC15_FRAME_TYPE::TELEM_ACK, &HC15TelemetryEncoder::onAck, this);
+    }
+
+    /*
+     * @brief Changes up to +-deadband (in raw channel units) are not reported.
+     */
+    void setDeadband(uint8_t channel, uint32_t deadband)
+    {
+        if (channel < CHANNELS)
+            deadband_[channel] = deadband;
+    }
+
+    void setKeyframeInterval(uint32_t ms) { keyframe_ms_ = ms; }
+
+    /*
+     * @brief Feed one sample per channel (already scaled to integers), sends only what the
+     *        receiver needs to know. Delta repeats are sent from here too, so call it periodically.
+     * @return true if a frame was sent; on a failed send nothing is recorded and the next call retries.
+     */
+    bool report(const int32_t values[CHANNELS])
+    {
+        uint32_t now = millis();
+        uint8_t payload[MAX_LEN];
+        uint8_t *p = payload;
+        int32_t prev[CHANNELS]; // 关键帧发送失败时恢复
+        uint32_t mask = 0;
+        bool repeat = false;
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        bool key_due = !acked_ || now - acked_ms_ >= keyframe_ms_;
+        bool need_key = key_due && (!key_sent_ || now - key_sent_ms_ >= HC15_TELEM_ACK_TIMEOUT_MS || (!acked_ && changed(values)));
+        if (!need_key && !acked_)
+        {
+            xSemaphoreGive(lock_);
+            return false; // 首个关键帧还没确认，等确认或超时重发
+        }
+        if (need_key)
+        {
+            // 未确认前没有差分基准，数值变了就直接发新关键帧；周期关键帧确认前仍按旧基准发差分
+            // 先记下待确认的关键帧，ACK 可能在 sendPort 返回前就到；发送失败再撤回
+            memcpy(prev, reported_, sizeof(prev));
+            pending_id_ = (pending_id_ + 1) & 0x7F;
+            *p++ = HC15_TELEM_KEYFRAME_BIT | pending_id_;
+            for (uint8_t i = 0; i < CHANNELS; i++)
+            {
+                pending_[i] = reported_[i] = values[i];
+                p = HC15Varint::put(p, values[i]);
+            }
+            key_sent_ = true;
+            key_sent_ms_ = now;
+        }
+        else
+        {
+            for (uint8_t i = 0; i < CHANNELS; i++)
+            {
+                if (exceeds(values[i], reported_[i], deadband_[i]))
+                    mask |= 1ul << i;
+            }
+            if (!mask && repeat_mask_ && now - delta_ms_ >= HC15_TELEM_REPEAT_MS)
+            {
+                mask = repeat_mask_; // 上次的差分可能丢在空中，再发一遍
+                repeat = true;
+            }
+            if (!mask)
+            {
+                xSemaphoreGive(lock_);
+                return false; // 没有越过死区的变化，不发
+            }
+            *p++ = acked_id_;
+            for (uint8_t b = 0; b < MASK_BYTES; b++)
+                *p++ = static_cast<uint8_t>(mask >> (8 * b));
+            for (uint8_t i = 0; i < CHANNELS; i++)
+            {
+                if (mask & (1ul << i))
+                    p = HC15Varint::put(p, values[i] - base_[i]);
+            }
+        }
+        xSemaphoreGive(lock_);
+
+        bool sent = link_->sendPort(dst_, port_, payload, static_cast<uint8_t>(p - payload));
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        if (need_key)
+        {
+            if (sent)
+            {
+                repeat_mask_ = 0; // 关键帧带了全部通道
+                keyframes_++;
+            }
+            else if (key_sent_ && key_sent_ms_ == now)
+            {
+                memcpy(reported_, prev, sizeof(prev));
+                key_sent_ = false; // 下次调用立即重发
+            }
+        }
+        else if (sent)
+        {
+            // 只有真正发出去的值才算接收端知道了
+            for (uint8_t i = 0; i < CHANNELS; i++)
+            {
+                if (mask & (1ul << i))
+                    reported_[i] = values[i];
+            }
+            if (repeat)
+            {
+                if (!repeats_left_ || !--repeats_left_)
+                    repeat_mask_ = 0;
+            }
+            else
+            {
+                repeat_mask_ = HC15_TELEM_DELTA_REPEATS ? repeat_mask_ | mask : 0;
+                repeats_left_ = HC15_TELEM_DELTA_REPEATS;
+            }
+            delta_ms_ = now;
+            deltas_++;
+        }
+        xSemaphoreGive(lock_);
+        return sent;
+    }
+
+    uint32_t keyframes() const { return keyframes_; }
+    uint32_t deltas() const { return deltas_; }
+
+private:
+    static bool exceeds(int32_t v, int32_t ref, uint32_t deadband)
+    {
+        int64_t d = static_cast<int64_t>(v) - ref;
+        return (d < 0 ? -d : d) > deadband;
+    }
+
+    bool changed(const int32_t values[CHANNELS]) const
+    {
+        for (uint8_t i = 0; i < CHANNELS; i++)
+        {
+            if (exceeds(values[i], reported_[i], deadband_[i]))
+                return true;
+        }
+        return false;
+    }
+
+    static bool onAck(const HC15Frame &frame, void *ctx)
+    {
+        HC15TelemetryEncoder *self = static_cast<HC15TelemetryEncoder *>(ctx);
+        if (frame.len < 2 || frame.payload[0] != self->port_ || frame.src != self->dst_)
+            return false;
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        if (frame.payload[1] == self->pending_id_ && self->key_sent_)
+        {
+            memcpy(self->base_, self->pending_, sizeof(self->base_));
+            self->acked_id_ = self->pending_id_;
+            self->acked_ = true;
+            self->acked_ms_ = self->key_sent_ms_;
+            self->key_sent_ = false;
+        }
+        xSemaphoreGive(self->lock_);
+        return true;
+    }
+
+    HC15Link *link_ = nullptr;
+    uint16_t dst_ = 0;
+    uint8_t port_ = HC15_TELEM_PORT;
+    SemaphoreHandle_t lock_ = nullptr;
+    uint32_t deadband_[CHANNELS];
+    uint32_t keyframe_ms_ = HC15_TELEM_KEYFRAME_MS;
+    int32_t reported_[CHANNELS] = {0}; // 接收端当前认为的值
+    int32_t pending_[CHANNELS] = {0};  // 已发出、待确认的关键帧
+    int32_t base_[CHANNELS] = {0};     // 已确认的关键帧，差分基准
+    uint8_t pending_id_ = 0;
+    uint8_t acked_id_ = 0;
+    bool key_sent_ = false;
+    bool acked_ = false;
+    uint32_t key_sent_ms_ = 0;
+    uint32_t acked_ms_ = 0;
+    uint32_t repeat_mask_ = 0; // 最近差分里变化、还要重发的通道
+    uint8_t repeats_left_ = 0;
+    uint32_t delta_ms_ = 0;
+    uint32_t keyframes_ = 0;
+    uint32_t deltas_ = 0;
+};
+
+/*
+ * Gateway side, one per node: rebuilds the channel values from keyframes and deltas.
+ * Transport independent; call ack() after a keyframe.
+ */
+template <uint8_t CHANNELS>
+class HC15TelemetryDecoder
+{
+    static_assert(CHANNELS >= 1 && CHANNELS <= 32, "1..32 channels");
+
+public:
+    static const uint8_t MASK_BYTES = (CHANNELS + 7) / 8;
+
+    HC15TelemetryDecoder()
+    {
+        memset(values_, 0, sizeof(values_));
+        for (uint8_t k = 0; k < HC15_TELEM_KEYFRAMES; k++)
+            key_ids_[k] = NO_KEY;
+    }
+
+    /*
+     * @brief Apply one telemetry payload.
+     * @param changed Receives the mask of channels that were updated.
+     * @return false if the payload is malformed or refers to an unknown keyframe (wait for the next one).
+     */
+    bool decode(const uint8_t *payload, size_t len, uint32_t &changed)
+    {
+        changed = 0;
+        if (len < 1)
+            return false;
+        const uint8_t *p = payload + 1;
+        const uint8_t *end = payload + len;
+        uint8_t id = payload[0] & 0x7F;
+
+        if (payload[0] & HC15_TELEM_KEYFRAME_BIT)
+        {
+            int32_t vals[CHANNELS];
+            for (uint8_t i = 0; i < CHANNELS; i++)
+            {
+                if (!(p = HC15Varint::get(p, end, vals[i])))
+                    return false;
+            }
+            uint8_t slot = findKey(id);
+            if (slot == NO_KEY)
+            {
+                slot = next_slot_;
+                next_slot_ = (next_slot_ + 1) % HC15_TELEM_KEYFRAMES;
+            }
+            key_ids_[slot] = id;
+            memcpy(keys_[slot], vals, sizeof(vals));
+            memcpy(values_, vals, sizeof(vals));
+            last_key_ = id;
+            changed = CHANNELS == 32 ? 0xFFFFFFFFul : ((1ul << CHANNELS) - 1);
+            return true;
+        }
+
+        uint8_t slot = findKey(id);
+        if (slot == NO_KEY || static_cast<size_t>(end - p) < MASK_BYTES)
+            return false;
+        const int32_t *base = keys_[slot];
+        uint32_t mask = 0;
+        for (uint8_t b = 0; b < MASK_BYTES; b++)
+            mask |= static_cast<uint32_t>(*p++) << (8 * b);
+
+        int32_t vals[CHANNELS];
+        memcpy(vals, values_, sizeof(vals));
+        for (uint8_t i = 0; i < CHANNELS; i++)
+        {
+            if (!(mask & (1ul << i)))
+                continue;
+            int32_t d;
+            if (!(p = HC15Varint::get(p, end, d)))
+                return false;
+            vals[i] = base[i] + d;
+        }
+        memcpy(values_, vals, sizeof(vals));
+        changed = mask;
+        return true;
+    }
+
+    /*
+     * @brief Acknowledge the last keyframe so the node can switch to deltas against it.
+     */
+    bool ack(HC15Link *link, uint16_t node, uint8_t port = HC15_TELEM_PORT) const
+    {
+        if (last_key_ == NO_KEY)
+            return false;
+        uint8_t payload[2] = {port, last_key_};
+        return link->send(node, HC15_FRAME_TYPE::TELEM_ACK, payload, sizeof(payload));
+    }
+
+    int32_t value(uint8_t channel) const { return channel < CHANNELS ? values_[channel] : 0; }
+    const int32_t *values() const { return values_; }
+
+private:
+    static const uint8_t NO_KEY = 0xFF;
+
+    uint8_t findKey(uint8_t id) const
+    {
+        for (uint8_t k = 0; k < HC15_TELEM_KEYFRAMES; k++)
+        {
+            if (key_ids_[k] == id)
+                return k;
+        }
+        return NO_KEY;
+    }
+
+    int32_t values_[CHANNELS];
+    int32_t keys_[HC15_TELEM_KEYFRAMES][CHANNELS];
+    uint8_t key_ids_[HC15_TELEM_KEYFRAMES];
+    uint8_t next_slot_ = 0;
+    uint8_t last_key_ = NO_KEY;
+};
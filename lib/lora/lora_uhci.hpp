@@ -0,0 +1,297 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/uart.h>
+#include <esp_private/gdma.h>
+#include <hal/dma_types.h>
+#include <hal/uart_ll.h>
+#include <hal/uhci_ll.h>
+#include <soc/uhci_struct.h>
+#if __has_include(<esp_private/periph_ctrl.h>)
+#include <esp_private/periph_ctrl.h>
+#else
+#include <driver/periph_ctrl.h>
+#endif
+#include <lora_class.hpp>
+#include <lora_gpio.hpp>
+
+/*
+ * UART through UHCI + GDMA on the ESP32-C3, for bulk transparent traffic.
+ *
+ * HardwareSerial takes an interrupt per FIFO threshold and copies byte by byte into its ring buffer.
+ * Here the UART is driven by UHCI0 without the UART driver installed: TX is one descriptor chain per
+ * send(), RX is a circular chain of HC15_UHCI_RX_BLOCKS buffers that the DMA fills on its own and
+ * closes with an EOF when the line goes idle, so the CPU only sees one interrupt per burst. Bursts
+ * longer than the ring are handled by rxTask() also checking the owner bits once per block time: full
+ * blocks go back to the DMA before the ring runs out, without waiting for the EOF.
+ *
+ * Configure the module with HC15 first (AT commands need the normal driver), then call
+ * serial->end() and begin() this backend on the same UART and pins. Only one UHCI exists; end()
+ * frees the DMA channels and UHCI0 so the normal driver can take the UART back.
+ */
+
+#ifndef HC15_UHCI_RX_BLOCK
+#define HC15_UHCI_RX_BLOCK 256 // 每个 RX 描述符的缓冲，须为 4 的倍数
+#endif
+
+#ifndef HC15_UHCI_RX_BLOCKS
+#define HC15_UHCI_RX_BLOCKS 8
+#endif
+
+#ifndef HC15_UHCI_TX_BUF
+#define HC15_UHCI_TX_BUF 1024 // DMA 可访问的发送缓冲，一次 send() 的上限
+#endif
+
+#ifndef HC15_UHCI_IDLE_CHARS
+#define HC15_UHCI_IDLE_CHARS 4 // 空闲多少个字符时间算一次突发结束
+#endif
+
+#define HC15_UHCI_DESC_MAX 4095 // 单个描述符的长度上限
+
+static_assert(HC15_UHCI_RX_BLOCK % 4 == 0 && HC15_UHCI_RX_BLOCK <= HC15_UHCI_DESC_MAX, "RX block size");
+
+class HC15UhciUart
+{
+public:
+    HC15UhciUart(uart_port_t uart, uint32_t baud, int rx_pin, int tx_pin, uint8_t sta_pin)
+        : uart_(uart), baud_(baud), rx_pin_(rx_pin), tx_pin_(tx_pin), sta_(sta_pin)
+    {
+        tx_done_ = xSemaphoreCreateBinary();
+        tx_lock_ = xSemaphoreCreateMutex();
+        rx_eof_ = xQueueCreate(HC15_UHCI_RX_BLOCKS, sizeof(intptr_t));
+    }
+
+    bool begin()
+    {
+        if (!tx_done_ || !tx_lock_ || !rx_eof_ || running_)
+            return false;
+
+        uart_config_t cfg;
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.baud_rate = static_cast<int>(baud_);
+        cfg.data_bits = UART_DATA_8_BITS;
+        cfg.parity = UART_PARITY_DISABLE;
+        cfg.stop_bits = UART_STOP_BITS_1;
+        cfg.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+        cfg.source_clk = UART_SCLK_APB;
+        if (uart_param_config(uart_, &cfg) != ESP_OK ||
+            uart_set_pin(uart_, tx_pin_, rx_pin_, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK)
+            return false;
+        uart_ll_set_rx_idle_thr(UART_LL_GET_HW(uart_), HC15_UHCI_IDLE_CHARS * 10); // 单位是 bit
+
+        periph_module_enable(PERIPH_UHCI0_MODULE);
+        uhci_on_ = true;
+        uhci_ll_init(&UHCI0);
+        uhci_ll_attach_uart_port(&UHCI0, uart_);
+        uhci_ll_rx_set_eof_mode(&UHCI0, UHCI_RX_IDLE_EOF); // 空闲即 EOF，一次突发一个 EOF
+
+        gdma_channel_alloc_config_t tx_cfg;
+        memset(&tx_cfg, 0, sizeof(tx_cfg));
+        tx_cfg.direction = GDMA_CHANNEL_DIRECTION_TX;
+        gdma_channel_alloc_config_t rx_cfg;
+        memset(&rx_cfg, 0, sizeof(rx_cfg));
+        rx_cfg.direction = GDMA_CHANNEL_DIRECTION_RX;
+        if (gdma_new_channel(&tx_cfg, &tx_chan_) != ESP_OK || gdma_new_channel(&rx_cfg, &rx_chan_) != ESP_OK)
+        {
+            end(); // TX 拿到了而 RX 没拿到时不能把 TX 通道漏掉
+            return false;
+        }
+        gdma_connect(tx_chan_, GDMA_MAKE_TRIGGER(GDMA_TRIG_PERIPH_UHCI, 0));
+        gdma_connect(rx_chan_, GDMA_MAKE_TRIGGER(GDMA_TRIG_PERIPH_UHCI, 0));
+
+        gdma_strategy_config_t strategy;
+        memset(&strategy, 0, sizeof(strategy));
+        strategy.owner_check = true; // 软件没取走的块不会被覆盖，满了 DMA 停下等 gdma_append
+        strategy.auto_update_desc = true;
+        gdma_apply_strategy(rx_chan_, &strategy);
+
+        gdma_tx_event_callbacks_t tx_cbs;
+        memset(&tx_cbs, 0, sizeof(tx_cbs));
+        tx_cbs.on_trans_eof = &HC15UhciUart::onTxEof;
+        gdma_register_tx_event_callbacks(tx_chan_, &tx_cbs, this);
+        gdma_rx_event_callbacks_t rx_cbs;
+        memset(&rx_cbs, 0, sizeof(rx_cbs));
+        rx_cbs.on_recv_eof = &HC15UhciUart::onRxEof;
+        gdma_register_rx_event_callbacks(rx_chan_, &rx_cbs, this);
+
+        for (uint8_t i = 0; i < HC15_UHCI_RX_BLOCKS; i++)
+        {
+            dma_descriptor_t &d = rx_desc_[i];
+            d.dw0.size = HC15_UHCI_RX_BLOCK;
+            d.dw0.length = 0;
+            d.dw0.suc_eof = 0;
+            d.dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+            d.buffer = rx_buf_[i];
+            d.next = &rx_desc_[(i + 1) % HC15_UHCI_RX_BLOCKS]; // 环形
+        }
+        rx_next_ = 0;
+        xQueueReset(rx_eof_);
+        gdma_start(rx_chan_, reinterpret_cast<intptr_t>(&rx_desc_[0]));
+        running_ = true;
+        return true;
+    }
+
+    /*
+     * @brief Stop both DMA channels, free them and release UHCI0; rxTask idles until the next begin().
+     *        Afterwards the UART can be reopened with HardwareSerial::begin().
+     */
+    void end()
+    {
+        running_ = false;
+        xSemaphoreTake(tx_lock_, portMAX_DELAY); // 等正在进行的 send() 结束
+        if (tx_chan_)
+        {
+            gdma_stop(tx_chan_);
+            gdma_disconnect(tx_chan_); // 未连接时返回错误，无碍
+            gdma_del_channel(tx_chan_);
+            tx_chan_ = nullptr;
+        }
+        if (rx_chan_)
+        {
+            gdma_stop(rx_chan_);
+            gdma_disconnect(rx_chan_);
+            gdma_del_channel(rx_chan_);
+            rx_chan_ = nullptr;
+        }
+        xSemaphoreGive(tx_lock_);
+        if (uhci_on_)
+            periph_module_disable(PERIPH_UHCI0_MODULE); // 关时钟并复位，UART 不再挂在 UHCI 上
+        uhci_on_ = false;
+    }
+
+    /*
+     * @brief Called once per received burst (or per full block of a long burst) from rxTask.
+     */
+    void setRxCallback(HC15RxCallback cb, void *ctx = nullptr)
+    {
+        rx_ctx_ = ctx;
+        rx_cb_ = cb;
+    }
+
+    /*
+     * @brief Send raw bytes with one DMA chain, same contract as HC15::send().
+     * @return The number of bytes written, or 0 if the module stayed busy or the DMA timed out.
+     */
+    int send(const uint8_t *data, size_t len, uint32_t timeout_ms = 5000)
+    {
+        if (!data || len == 0 || len > HC15_UHCI_TX_BUF)
+            return 0;
+        if (xSemaphoreTake(tx_lock_, pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+            return 0;
+        uint32_t time1 = millis();
+        while (!sta_.read() && millis() - time1 < timeout_ms)
+            vTaskDelay(1); // STA 低 = 模块正在收/发
+        int written = 0;
+        if (tx_chan_ && sta_.read())
+        {
+            memcpy(tx_buf_, data, len); // 调用者的缓冲不一定在 DMA 可访问的内存里
+            uint8_t n = 0;
+            for (size_t off = 0; off < len; off += HC15_UHCI_DESC_MAX, n++)
+            {
+                size_t chunk = len - off < HC15_UHCI_DESC_MAX ? len - off : HC15_UHCI_DESC_MAX;
+                dma_descriptor_t &d = tx_desc_[n];
+                d.dw0.size = chunk;
+                d.dw0.length = chunk;
+                d.dw0.suc_eof = off + chunk == len;
+                d.dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+                d.buffer = tx_buf_ + off;
+                d.next = d.dw0.suc_eof ? nullptr : &tx_desc_[n + 1];
+            }
+            xSemaphoreTake(tx_done_, 0);
+            gdma_start(tx_chan_, reinterpret_cast<intptr_t>(&tx_desc_[0]));
+            // 等 DMA 搬完，最多按 2 倍线路时间
+            uint32_t wire_ms = static_cast<uint32_t>(len * 10000ull / baud_) * 2 + 10;
+            if (xSemaphoreTake(tx_done_, pdMS_TO_TICKS(wire_ms)) == pdTRUE)
+                written = static_cast<int>(len);
+            else
+                gdma_stop(tx_chan_);
+        }
+        xSemaphoreGive(tx_lock_);
+        return written;
+    }
+
+    /*
+     * @brief Hands filled RX blocks to the callback and gives them back to the DMA, use rtos task please.
+     */
+    void rxTask(void * /*pvParameters*/)
+    {
+        // 写满一个块的线路时间：长突发时按这个节奏把满块还给 DMA，环不会被占满
+        uint32_t block_ms = static_cast<uint32_t>(HC15_UHCI_RX_BLOCK * 10000ull / baud_);
+        TickType_t poll = pdMS_TO_TICKS(block_ms) ? pdMS_TO_TICKS(block_ms) : 1;
+        for (;;)
+        {
+            intptr_t eof = 0; // 超时醒来：没有 EOF，只收 DMA 已交还（写满）的块
+            xQueueReceive(rx_eof_, &eof, poll);
+            if (!running_)
+                continue; // end() 之后描述符不再属于 DMA 环
+
+            // 从上次位置走到 EOF 描述符或第一个仍归 DMA 的块
+            uint8_t returned = 0;
+            for (uint8_t guard = 0; guard < HC15_UHCI_RX_BLOCKS; guard++)
+            {
+                dma_descriptor_t &d = rx_desc_[rx_next_];
+                if (d.dw0.owner == DMA_DESCRIPTOR_BUFFER_OWNER_DMA)
+                    break; // 还在写，或已经处理过（EOF 合并了）
+                size_t len = d.dw0.length;
+                if (len && rx_cb_)
+                    rx_cb_(static_cast<const uint8_t *>(d.buffer), len, rx_ctx_);
+                rx_bytes_ += len;
+                bool last = reinterpret_cast<intptr_t>(&d) == eof;
+                d.dw0.length = 0;
+                d.dw0.suc_eof = 0;
+                d.dw0.owner = DMA_DESCRIPTOR_BUFFER_OWNER_DMA;
+                rx_next_ = (rx_next_ + 1) % HC15_UHCI_RX_BLOCKS;
+                returned++;
+                if (last)
+                    break;
+            }
+            if (returned)
+                gdma_append(rx_chan_); // 块还回去了，若 DMA 因 owner 检查停下则继续
+        }
+    }
+
+    uint32_t rxBytes() const { return rx_bytes_; }
+    uint32_t rxOverruns() const { return rx_overruns_; }
+
+private:
+    static bool IRAM_ATTR onTxEof(gdma_channel_handle_t, gdma_event_data_t *, void *ctx)
+    {
+        HC15UhciUart *self = static_cast<HC15UhciUart *>(ctx);
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(self->tx_done_, &woken);
+        return woken == pdTRUE;
+    }
+
+    static bool IRAM_ATTR onRxEof(gdma_channel_handle_t, gdma_event_data_t *event, void *ctx)
+    {
+        HC15UhciUart *self = static_cast<HC15UhciUart *>(ctx);
+        BaseType_t woken = pdFALSE;
+        intptr_t eof = event->rx_eof_desc_addr;
+        if (xQueueSendFromISR(self->rx_eof_, &eof, &woken) != pdTRUE)
+            self->rx_overruns_++; // 任务跟不上，块仍由软件持有，下次 EOF 会一起处理
+        return woken == pdTRUE;
+    }
+
+    uart_port_t uart_;
+    uint32_t baud_;
+    int rx_pin_;
+    int tx_pin_;
+    HC15FastPin sta_;
+    gdma_channel_handle_t tx_chan_ = nullptr;
+    gdma_channel_handle_t rx_chan_ = nullptr;
+    SemaphoreHandle_t tx_done_ = nullptr;
+    SemaphoreHandle_t tx_lock_ = nullptr;
+    QueueHandle_t rx_eof_ = nullptr;
+    HC15RxCallback rx_cb_ = nullptr;
+    void *rx_ctx_ = nullptr;
+    uint8_t rx_next_ = 0;
+    volatile uint32_t rx_overruns_ = 0;
+    volatile bool running_ = false;
+    bool uhci_on_ = false; // periph_module_enable 有引用计数，只配对关一次
+    uint32_t rx_bytes_ = 0;
+
+    // 描述符和缓冲是成员，对象须放在内部 RAM（全局 / 静态对象即可）
+    dma_descriptor_t tx_desc_[(HC15_UHCI_TX_BUF + HC15_UHCI_DESC_MAX - 1) / HC15_UHCI_DESC_MAX] __attribute__((aligned(4)));
+    dma_descriptor_t rx_desc_[HC15_UHCI_RX_BLOCKS] __attribute__((aligned(4)));
+    uint8_t tx_buf_[HC15_UHCI_TX_BUF] __attribute__((aligned(4)));
+    uint8_t rx_buf_[HC15_UHCI_RX_BLOCKS][HC15_UHCI_RX_BLOCK] __attribute__((aligned(4)));
+};
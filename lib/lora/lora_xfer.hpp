@@ -0,0 +1,508 @@
+#pragma once
+#include <Arduino.h>
+#include <lora_link.hpp>
+#include <lora_bitmap.hpp>
+#include <lora_sha256.hpp>
+
+/*
+ * Resumable bulk transfer (log files, configs) between two nodes.
+ *
+ * OFFER(id, size, sha256) -> STATUS(received bitmap). The sender then pipelines a window of missing
+ * chunks, the last one asking for a STATUS, and repeats from the new bitmap. The receiver keeps its
+ * bitmap in HC15XferState; persisting it (setPersist) and handing it back after a reboot (resume)
+ * lets a repeated OFFER continue where it stopped. When the bitmap is full the receiver's verifyTask()
+ * reads the file back, checks the SHA-256 and answers DONE.
+ */
+
+#ifndef HC15_XFER_MAX_CHUNKS
+#define HC15_XFER_MAX_CHUNKS (HC15_XFER_STATUS_BYTES * 8) // 单文件最多分块数，一个 STATUS 装得下的位图（约 66 KB）
+#endif
+
+#ifndef HC15_XFER_MAX_RETRIES
+#define HC15_XFER_MAX_RETRIES 5 // 连续收不到 STATUS 的次数上限
+#endif
+
+#define HC15_XFER_CHUNK_HEADER 5
+#define HC15_XFER_CHUNK_SIZE (HC15_FRAME_MAX_PAYLOAD - HC15_XFER_CHUNK_HEADER)
+#define HC15_XFER_STATUS_HEADER 4
+#define HC15_XFER_STATUS_BYTES (HC15_FRAME_MAX_PAYLOAD - HC15_XFER_STATUS_HEADER)
+#define HC15_XFER_CTL_ACK_REQ 0x01
+#define HC15_XFER_STATUS_TIMEOUT_MS 1000 // 等 STATUS 的固定余量，另加窗口的空中时间
+
+static_assert((HC15_XFER_MAX_CHUNKS + 7) / 8 <= HC15_XFER_STATUS_BYTES, "HC15_XFER_MAX_CHUNKS: bitmap must fit in one STATUS frame");
+
+enum class HC15_XFER_RESULT
+{
+    OK = 0,
+    HASH_MISMATCH = 1, // 接收端校验失败，已清空重来
+    TIMEOUT = 2,
+    INVALID = 3,
+    READ_ERROR = 4,
+};
+
+struct HC15XferState
+{
+    uint16_t id = 0;
+    uint32_t size = 0;
+    uint8_t sha256[32] = {0};
+    HC15Bitmap<HC15_XFER_MAX_CHUNKS> have;
+};
+
+/*
+ * @brief Save the receiver state (e.g. to NVS / LittleFS) so a reboot can resume().
+ */
+typedef void (*HC15XferPersist)(const HC15XferState &state, void *ctx);
+
+/*
+ * @brief Called once a file is complete and its hash verified.
+ */
+typedef void (*HC15XferComplete)(const HC15XferState &state, void *ctx);
+
+class HC15XferSha256
+{
+public:
+    /*
+     * @brief SHA-256 of size bytes pulled through reader (hardware SHA on the ESP32-C3 via mbedtls).
+     * @return false if the reader came up short or the hash failed.
+     */
+    static bool compute(uint32_t size, HC15BlobReader reader, void *ctx, uint8_t out[32])
+    {
+        HC15Sha256 sha;
+        uint8_t buf[64];
+        bool ok = sha.starts();
+        for (uint32_t off = 0; off < size && ok;)
+        {
+            size_t len = size - off < sizeof(buf) ? size - off : sizeof(buf);
+            ok = reader(off, buf, len, ctx) == len && sha.update(buf, len);
+            off += len;
+        }
+        return ok && sha.finish(out);
+    }
+};
+
+class HC15XferSender
+{
+public:
+    explicit HC15XferSender(HC15Link *link) : link_(link)
+    {
+        lock_ = xSemaphoreCreateMutex();
+        status_event_ = xSemaphoreCreateBinary();
+    }
+
+    bool begin()
+    {
+        if (!link_ || !lock_ || !status_event_)
+            return false;
+        return link_->addHandler(HC15_FRAME_TYPE::XFER_STATUS, &HC15XferSender::onStatus, this) &&
+               link_->addHandler(HC15_FRAME_TYPE::XFER_DONE, &HC15XferSender::onDone, this);
+    }
+
+    /*
+     * @brief Chunks sent back to back before asking for a STATUS.
+     */
+    void setWindow(uint8_t chunks) { window_ = chunks ? chunks : 1; }
+
+    /*
+     * @brief Window that keeps one burst within budget_ms of airtime.
+     * @param air_bps The configured air data rate (see setSpeed()).
+     */
+    static uint8_t windowForAirtime(uint32_t air_bps, uint32_t budget_ms)
+    {
+        uint32_t chunk_ms = (HC15_FRAME_OVERHEAD + HC15_FRAME_MAX_PAYLOAD) * 10UL * 1000UL / (air_bps ? air_bps : 1);
+        uint32_t w = budget_ms / (chunk_ms ? chunk_ms : 1);
+        return static_cast<uint8_t>(w < 1 ? 1 : (w > 32 ? 32 : w));
+    }
+
+    /*
+     * @brief Transfer a file to dst, blocking. Calling it again with the same id resumes.
+     */
+    HC15_XFER_RESULT send(uint16_t dst, uint16_t id, uint32_t size, HC15BlobReader reader, void *ctx)
+    {
+        uint32_t total = (size + HC15_XFER_CHUNK_SIZE - 1) / HC15_XFER_CHUNK_SIZE;
+        if (!reader || dst == HC15_BROADCAST_ID || total == 0 || total > HC15_XFER_MAX_CHUNKS)
+            return HC15_XFER_RESULT::INVALID;
+
+        uint8_t payload[HC15_FRAME_MAX_PAYLOAD];
+        // OFFER: id + size + sha256
+        HC15FrameCodec::put16(payload, id);
+        for (uint8_t i = 0; i < 4; i++)
+            payload[2 + i] = static_cast<uint8_t>(size >> (8 * i));
+        if (!HC15XferSha256::compute(size, reader, ctx, payload + 6))
+            return HC15_XFER_RESULT::READ_ERROR;
+        uint8_t offer[38];
+        memcpy(offer, payload, sizeof(offer));
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        dst_ = dst;
+        id_ = id;
+        have_.clear();
+        done_ = false;
+        xSemaphoreGive(lock_);
+        xSemaphoreTake(status_event_, 0);
+
+        uint32_t wait_ms = HC15_XFER_STATUS_TIMEOUT_MS +
+                           static_cast<uint32_t>(window_) * (HC15_FRAME_MAX_WIRE * 10UL * 1000UL / 9600UL); // 按最慢常用空速估
+        uint8_t retries = 0;
+        uint16_t acked = 0;
+        bool need_offer = true;
+        bool complete = false;
+        for (;;)
+        {
+            if (need_offer)
+            {
+                link_->send(dst, HC15_FRAME_TYPE::XFER_OFFER, offer, sizeof(offer));
+                need_offer = false;
+            }
+            else if (!complete)
+            {
+                xSemaphoreTake(lock_, portMAX_DELAY);
+                HC15Bitmap<HC15_XFER_MAX_CHUNKS> have = have_;
+                xSemaphoreGive(lock_);
+
+                // 一个窗口：从第一个缺口开始发缺的块，最后一块要求回 STATUS
+                int idx = have.firstClear(total);
+                for (uint8_t n = 0; n < window_ && idx >= 0; n++)
+                {
+                    int next = have.firstClear(total, idx + 1);
+                    uint32_t offset = static_cast<uint32_t>(idx) * HC15_XFER_CHUNK_SIZE;
+                    size_t len = size - offset < HC15_XFER_CHUNK_SIZE ? size - offset : HC15_XFER_CHUNK_SIZE;
+                    HC15FrameCodec::put16(payload, id);
+                    HC15FrameCodec::put16(payload + 2, idx);
+                    payload[4] = (n + 1 == window_ || next < 0) ? HC15_XFER_CTL_ACK_REQ : 0;
+                    if (reader(offset, payload + HC15_XFER_CHUNK_HEADER, len, ctx) != len)
+                        return HC15_XFER_RESULT::READ_ERROR;
+                    if (link_->send(dst, HC15_FRAME_TYPE::XFER_CHUNK, payload, HC15_XFER_CHUNK_HEADER + len))
+                        chunks_sent_++;
+                    idx = next;
+                }
+            }
+            // complete: 块都到了，只等接收端校验完回 DONE
+
+            if (xSemaphoreTake(status_event_, pdMS_TO_TICKS(wait_ms)) != pdTRUE)
+            {
+                if (++retries > HC15_XFER_MAX_RETRIES)
+                    return HC15_XFER_RESULT::TIMEOUT;
+                need_offer = true; // OFFER 兼做探测，接收端会回 STATUS 或重发 DONE
+                continue;
+            }
+
+            xSemaphoreTake(lock_, portMAX_DELAY);
+            bool done = done_;
+            uint8_t result = done_result_;
+            uint16_t count = have_.count(total);
+            xSemaphoreGive(lock_);
+            if (done)
+                return result == 0 ? HC15_XFER_RESULT::OK : HC15_XFER_RESULT::HASH_MISMATCH;
+            // 只有确认数增加才算进展，接收端一直回 STATUS 却不收块时也会超时退出
+            if (count > acked)
+                retries = 0;
+            else if (++retries > HC15_XFER_MAX_RETRIES)
+                return HC15_XFER_RESULT::TIMEOUT;
+            acked = count;
+            complete = count == total; // 接收端丢了状态时快照会变少，重新发缺的块
+        }
+    }
+
+    uint32_t chunksSent() const { return chunks_sent_; }
+
+private:
+    static bool onStatus(const HC15Frame &frame, void *ctx)
+    {
+        HC15XferSender *self = static_cast<HC15XferSender *>(ctx);
+        if (frame.len < HC15_XFER_STATUS_HEADER)
+            return true;
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        bool mine = frame.src == self->dst_ && HC15FrameCodec::get16(frame.payload) == self->id_;
+        if (mine)
+        {
+            // STATUS 是从 first byte 开始的完整快照，之前的字节视为全收，之后的以快照为准（覆盖而不是合并）
+            uint16_t first = HC15FrameCodec::get16(frame.payload + 2);
+            self->have_.assign(first, frame.payload + HC15_XFER_STATUS_HEADER, frame.len - HC15_XFER_STATUS_HEADER);
+        }
+        xSemaphoreGive(self->lock_);
+        if (mine)
+            xSemaphoreGive(self->status_event_);
+        return true;
+    }
+
+    static bool onDone(const HC15Frame &frame, void *ctx)
+    {
+        HC15XferSender *self = static_cast<HC15XferSender *>(ctx);
+        if (frame.len < 3)
+            return true;
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        bool mine = frame.src == self->dst_ && HC15FrameCodec::get16(frame.payload) == self->id_;
+        if (mine)
+        {
+            self->done_ = true;
+            self->done_result_ = frame.payload[2];
+        }
+        xSemaphoreGive(self->lock_);
+        if (mine)
+            xSemaphoreGive(self->status_event_);
+        return true;
+    }
+
+    HC15Link *link_ = nullptr;
+    SemaphoreHandle_t lock_ = nullptr;
+    SemaphoreHandle_t status_event_ = nullptr;
+    uint8_t window_ = 8;
+    uint16_t dst_ = HC15_BROADCAST_ID;
+    uint16_t id_ = 0;
+    HC15Bitmap<HC15_XFER_MAX_CHUNKS> have_; // 接收端确认过的块
+    bool done_ = false;
+    uint8_t done_result_ = 0;
+    uint32_t chunks_sent_ = 0;
+};
+
+class HC15XferReceiver
+{
+public:
+    /*
+     * @param first_id, last_id Transfer ids this receiver handles, others are left to the next
+     *        receiver on the link (e.g. OTA uses its own range).
+     */
+    explicit HC15XferReceiver(HC15Link *link, uint16_t first_id = 0, uint16_t last_id = 0xFFFF)
+        : link_(link), first_id_(first_id), last_id_(last_id)
+    {
+        lock_ = xSemaphoreCreateMutex();
+        verify_event_ = xSemaphoreCreateBinary();
+    }
+
+    /*
+     * @param writer Stores incoming chunks.
+     * @param reader Reads the stored file back for the final hash check.
+     */
+    bool begin(HC15BlobWriter writer, HC15BlobReader reader, void *ctx)
+    {
+        if (!link_ || !writer || !reader || !lock_ || !verify_event_)
+            return false;
+        writer_ = writer;
+        reader_ = reader;
+        io_ctx_ = ctx;
+        return link_->addHandler(HC15_FRAME_TYPE::XFER_OFFER, &HC15XferReceiver::onOffer, this) &&
+               link_->addHandler(HC15_FRAME_TYPE::XFER_CHUNK, &HC15XferReceiver::onChunk, this);
+    }
+
+    /*
+     * @brief Persist the state every `every` stored chunks (and on completion).
+     */
+    void setPersist(HC15XferPersist persist, void *ctx, uint16_t every = 16)
+    {
+        persist_ = persist;
+        persist_ctx_ = ctx;
+        persist_every_ = every ? every : 1;
+    }
+
+    void setCompleteCallback(HC15XferComplete cb, void *ctx)
+    {
+        complete_ = cb;
+        complete_ctx_ = ctx;
+    }
+
+    /*
+     * @brief Restore a state saved by the persist callback, call before begin() traffic starts.
+     */
+    void resume(const HC15XferState &state)
+    {
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        state_ = state;
+        total_ = chunks(state_.size);
+        verified_ = false;
+        verifying_ = false;
+        xSemaphoreGive(lock_);
+    }
+
+    /*
+     * @brief Check the SHA-256 of completed files and answer DONE, use rtos task please.
+     *        Reading the whole file back would otherwise stall the link's monitorTask.
+     */
+    void verifyTask(void * /*pvParameters*/)
+    {
+        for (;;)
+            verify();
+    }
+
+    /*
+     * @brief Wait until all chunks of a file are in, then verify it (what verifyTask() runs).
+     *        The complete callback is called from here.
+     * @return true if the file checked out.
+     */
+    bool verify()
+    {
+        if (xSemaphoreTake(verify_event_, portMAX_DELAY) != pdTRUE)
+            return false;
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        HC15XferState st = state_;
+        uint16_t src = verify_src_;
+        xSemaphoreGive(lock_);
+
+        uint8_t sha[32];
+        bool ok = HC15XferSha256::compute(st.size, reader_, io_ctx_, sha) && memcmp(sha, st.sha256, 32) == 0;
+
+        xSemaphoreTake(lock_, portMAX_DELAY);
+        // 校验期间来了新文件的 OFFER，结果作废
+        bool current = verifying_ && state_.id == st.id && state_.size == st.size && memcmp(state_.sha256, st.sha256, 32) == 0;
+        if (current)
+        {
+            verifying_ = false;
+            if (ok)
+                verified_ = true;
+            else
+                state_.have.clear(); // 文件坏了，整个重传
+            persist();
+        }
+        xSemaphoreGive(lock_);
+        if (!current)
+            return false;
+
+        sendDone(src, st.id, ok ? 0 : 1);
+        if (ok && complete_)
+            complete_(st, complete_ctx_);
+        return ok;
+    }
+
+    const HC15XferState &state() const { return state_; }
+    bool verified() const { return verified_; }
+    uint32_t received() const { return state_.have.count(total_); }
+
+private:
+    bool mine(uint16_t id) const
+    {
+        return id >= first_id_ && id <= last_id_;
+    }
+
+    static uint32_t chunks(uint32_t size)
+    {
+        uint32_t total = (size + HC15_XFER_CHUNK_SIZE - 1) / HC15_XFER_CHUNK_SIZE;
+        return total > HC15_XFER_MAX_CHUNKS ? HC15_XFER_MAX_CHUNKS : total;
+    }
+
+    void sendStatus(uint16_t dst)
+    {
+        uint8_t payload[HC15_FRAME_MAX_PAYLOAD];
+        int first = state_.have.firstClear(total_);
+        uint16_t first_byte = first < 0 ? (total_ + 7) / 8 : first / 8;
+        uint16_t n = (total_ + 7) / 8 - first_byte;
+        if (n > HC15_XFER_STATUS_BYTES)
+            n = HC15_XFER_STATUS_BYTES;
+        HC15FrameCodec::put16(payload, state_.id);
+        HC15FrameCodec::put16(payload + 2, first_byte);
+        memcpy(payload + HC15_XFER_STATUS_HEADER, state_.have.bytes() + first_byte, n);
+        link_->send(dst, HC15_FRAME_TYPE::XFER_STATUS, payload, HC15_XFER_STATUS_HEADER + n);
+    }
+
+    void sendDone(uint16_t dst, uint16_t id, uint8_t result)
+    {
+        uint8_t payload[3];
+        HC15FrameCodec::put16(payload, id);
+        payload[2] = result;
+        link_->send(dst, HC15_FRAME_TYPE::XFER_DONE, payload, sizeof(payload));
+    }
+
+    void persist()
+    {
+        if (persist_)
+            persist_(state_, persist_ctx_);
+        since_persist_ = 0;
+    }
+
+    /*
+     * @brief Hand a fully received file to verifyTask(), lock held.
+     */
+    void checkComplete(uint16_t src)
+    {
+        if (verified_ || verifying_ || total_ == 0 || state_.have.count(total_) != total_)
+            return;
+        verifying_ = true;
+        verify_src_ = src;
+        xSemaphoreGive(verify_event_);
+    }
+
+    static bool onOffer(const HC15Frame &frame, void *ctx)
+    {
+        HC15XferReceiver *self = static_cast<HC15XferReceiver *>(ctx);
+        if (frame.len < 38)
+            return true;
+        uint16_t id = HC15FrameCodec::get16(frame.payload);
+        if (!self->mine(id))
+            return false;
+        uint32_t size = frame.payload[2] | (frame.payload[3] << 8) | (frame.payload[4] << 16) | (static_cast<uint32_t>(frame.payload[5]) << 24);
+        const uint8_t *sha = frame.payload + 6;
+
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        HC15XferState &st = self->state_;
+        if (st.id != id || st.size != size || memcmp(st.sha256, sha, 32) != 0)
+        {
+            // 新文件（或内容变了），从头开始
+            st.id = id;
+            st.size = size;
+            memcpy(st.sha256, sha, 32);
+            st.have.clear();
+            self->total_ = chunks(size);
+            self->verified_ = false;
+            self->verifying_ = false;
+            self->persist();
+        }
+        if (self->verified_)
+            self->sendDone(frame.src, id, 0); // 已经收完校验过，发送端重启后再问
+        else
+            self->sendStatus(frame.src);
+        self->checkComplete(frame.src); // resume() 回来的状态可能已经收满
+        xSemaphoreGive(self->lock_);
+        return true;
+    }
+
+    static bool onChunk(const HC15Frame &frame, void *ctx)
+    {
+        HC15XferReceiver *self = static_cast<HC15XferReceiver *>(ctx);
+        if (frame.len <= HC15_XFER_CHUNK_HEADER || !self->mine(HC15FrameCodec::get16(frame.payload)))
+            return false;
+        xSemaphoreTake(self->lock_, portMAX_DELAY);
+        HC15XferState &st = self->state_;
+        if (HC15FrameCodec::get16(frame.payload) != st.id || self->total_ == 0)
+        {
+            xSemaphoreGive(self->lock_);
+            return true;
+        }
+        uint16_t idx = HC15FrameCodec::get16(frame.payload + 2);
+        uint8_t ctl = frame.payload[4];
+
+        if (idx < self->total_ && !st.have.test(idx))
+        {
+            uint32_t offset = static_cast<uint32_t>(idx) * HC15_XFER_CHUNK_SIZE;
+            if (self->writer_(offset, frame.payload + HC15_XFER_CHUNK_HEADER, frame.len - HC15_XFER_CHUNK_HEADER, self->io_ctx_))
+            {
+                st.have.set(idx);
+                if (++self->since_persist_ >= self->persist_every_)
+                    self->persist();
+            }
+        }
+
+        self->checkComplete(frame.src); // 哈希在 verifyTask 里算，不挡住收帧
+        if (ctl & HC15_XFER_CTL_ACK_REQ)
+            self->sendStatus(frame.src); // 收满时发送端据此停发，等 DONE
+        xSemaphoreGive(self->lock_);
+        return true;
+    }
+
+    HC15Link *link_ = nullptr;
+    SemaphoreHandle_t lock_ = nullptr;
+    SemaphoreHandle_t verify_event_ = nullptr;
+    uint16_t first_id_ = 0;
+    uint16_t last_id_ = 0xFFFF;
+    HC15BlobWriter writer_ = nullptr;
+    HC15BlobReader reader_ = nullptr;
+    void *io_ctx_ = nullptr;
+    HC15XferPersist persist_ = nullptr;
+    void *persist_ctx_ = nullptr;
+    HC15XferComplete complete_ = nullptr;
+    void *complete_ctx_ = nullptr;
+    uint16_t persist_every_ = 16;
+    uint16_t since_persist_ = 0;
+    HC15XferState state_;
+    uint32_t total_ = 0;
+    bool verified_ = false;
+    bool verifying_ = false; // 已交给 verifyTask，等结果
+    uint16_t verify_src_ = 0;
+};
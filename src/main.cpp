@@ -1,18 +1,26 @@
 #include <Arduino.h>
 #include <builtin_led.hpp>
 #include <lora_class.hpp>
+#ifdef HC15_BRIDGE_MODE
+#include <lora_bridge.hpp>
+#endif
 
 /* ---------- 全局 / 静态 HC15 实例 ---------- */
 static HC15 hc15(&Serial1, // 注意取地址 &
                  115200,   // baud
-                 1, 0,     // RX, TX (顺序要和 Serial1.begin 一致)
+                 1, 0,     // RX, TX (hc15.begin 里打开 Serial1)
                  5000,     // 默认超时
                  12, 18);  // STA, KEY
 
+#ifdef HC15_BRIDGE_MODE
+/* 网关模式：电台字节原样转发到 USB，不再逐行打印 */
+static HC15UsbBridge bridge(&hc15, &Serial);
+#endif
+
 void setup()
 {
   Serial.begin(115200);
-  Serial.println("lora test begin");
+  HC15_LOG("lora test begin"); // 桥接模式下 Serial 是主机数据口，文本一律不输出
 
   /* LED 任务 */
   builtin_led_setup();
@@ -23,18 +31,19 @@ void setup()
               4,
               nullptr);
 
-  /* 串口先启动 */
-  Serial1.begin(115200, SERIAL_8N1, 1, 0);
-
   /* 初始化 HC-15 */
   if (!hc15.begin())
   {
-    Serial.println("HC15 initialization failed!");
+    HC15_LOG("HC15 initialization failed!");
     return;
   }
-  Serial.println("test begin");
-  Serial.println(hc15.getChannel());
-  Serial.println("done");
+#if defined(HC15_GPIO_BENCH) && !defined(HC15_BRIDGE_MODE)
+  /* STA / KEY 访问开销：Arduino 接口 vs 寄存器直读写 */
+  HC15GpioBench<12, 18>::print(&Serial, HC15GpioBench<12, 18>::run());
+#endif
+  HC15_LOG("test begin");
+  HC15_LOG(hc15.getChannel());
+  HC15_LOG("done");
 
   /* 监控任务 */
   xTaskCreate(
@@ -47,6 +56,19 @@ void setup()
       1,
       nullptr);
 
+#ifdef HC15_BRIDGE_MODE
+  if (!bridge.begin())
+  {
+    HC15_LOG("bridge initialization failed!");
+    return;
+  }
+  xTaskCreate([](void *pv) { static_cast<HC15UsbBridge *>(pv)->uplinkTask(nullptr); },
+              "HC15 uplink task", 4096, &bridge, 2, nullptr);
+  xTaskCreate([](void *pv) { static_cast<HC15UsbBridge *>(pv)->hostTask(nullptr); },
+              "HC15 host task", 4096, &bridge, 1, nullptr);
+  xTaskCreate([](void *pv) { static_cast<HC15UsbBridge *>(pv)->downlinkTask(nullptr); },
+              "HC15 downlink task", 4096, &bridge, 1, nullptr);
+#else
   xTaskCreate(
       [](void * /*pv*/)
       {
@@ -73,6 +95,7 @@ void setup()
       nullptr,
       1,
       nullptr);
+#endif
 }
 
 void loop() {} // 主循环留空
@@ -0,0 +1,223 @@
+#include <unity.h>
+#include <lora_delta.hpp>
+
+#define OLD_SIZE 300
+#define NEW_SIZE (100 + 50 + 5 + 30)
+
+static uint8_t old_[OLD_SIZE];
+static uint8_t expect_[NEW_SIZE];
+static uint8_t out_[512];
+static uint8_t patch_[HC15_DELTA_HEADER_LEN + 64];
+static size_t patch_len_ = 0;
+
+static size_t readOld(uint32_t offset, uint8_t *out, size_t len, void *)
+{
+    if (offset + len > OLD_SIZE)
+        return 0;
+    memcpy(out, old_ + offset, len);
+    return len;
+}
+
+static bool writeOut(uint32_t offset, const uint8_t *data, size_t len, void *)
+{
+    if (offset + len > sizeof(out_))
+        return false;
+    memcpy(out_ + offset, data, len);
+    return true;
+}
+
+static void put8(uint8_t v) { patch_[patch_len_++] = v; }
+
+static void put32(uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        put8(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+static void putVarint(uint32_t v)
+{
+    while (v >= 0x80)
+    {
+        put8(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    put8(static_cast<uint8_t>(v));
+}
+
+static void putOp(HC15_DELTA_OP op, uint32_t len)
+{
+    put8(static_cast<uint8_t>(op));
+    putVarint(len);
+}
+
+/*
+ * @brief Build a patch using every op, and the image it should produce.
+ *        new = old[0, 100) | old[100, 150) + diffs | 5 literal bytes | old[130, 160)
+ */
+static void buildPatch(void)
+{
+    for (int i = 0; i < OLD_SIZE; i++)
+        old_[i] = static_cast<uint8_t>(i * 7 + 3);
+
+    memcpy(expect_, old_, 100);
+    memcpy(expect_ + 100, old_ + 100, 50);
+    expect_[110] += 0x03;
+    expect_[111] += 0xFF;
+    expect_[149] += 0x01;
+    const uint8_t lit[5] = {'h', 'c', '1', '5', 0};
+    memcpy(expect_ + 150, lit, 5);
+    memcpy(expect_ + 155, old_ + 130, 30);
+
+    patch_len_ = 0;
+    memcpy(patch_, HC15_DELTA_MAGIC, 4);
+    patch_len_ = 4;
+    put32(OLD_SIZE);
+    HC15Sha256::compute(old_, OLD_SIZE, patch_ + patch_len_);
+    patch_len_ += 32;
+    put32(NEW_SIZE);
+    HC15Sha256::compute(expect_, NEW_SIZE, patch_ + patch_len_);
+    patch_len_ += 32;
+
+    putOp(HC15_DELTA_OP::COPY, 100);
+    putOp(HC15_DELTA_OP::ADD, 50);
+    put8(0); // 10 个零差值
+    putVarint(10);
+    put8(0x03);
+    put8(0xFF);
+    put8(0); // 37 个零差值
+    putVarint(37);
+    put8(0x01);
+    putOp(HC15_DELTA_OP::INSERT, 5);
+    for (int i = 0; i < 5; i++)
+        put8(lit[i]);
+    putOp(HC15_DELTA_OP::SEEK, (19 << 1) | 1); // zigzag(-20)
+    putOp(HC15_DELTA_OP::COPY, 30);
+}
+
+/*
+ * @brief Apply patch_ fed in pieces of step bytes.
+ */
+static HC15_OTA_RESULT apply(size_t step)
+{
+    HC15DeltaHeader header;
+    if (!header.parse(patch_))
+        return HC15_OTA_RESULT::BAD_PATCH;
+    memset(out_, 0, sizeof(out_));
+    HC15DeltaApplier applier;
+    applier.begin(header, readOld, nullptr, writeOut, nullptr);
+    for (size_t i = HC15_DELTA_HEADER_LEN; i < patch_len_; i += step)
+    {
+        size_t n = patch_len_ - i < step ? patch_len_ - i : step;
+        if (!applier.feed(patch_ + i, n))
+            return applier.result();
+    }
+    return applier.finish();
+}
+
+void setUp(void)
+{
+    buildPatch();
+}
+
+void tearDown(void) {}
+
+void test_sha256_known_answer(void)
+{
+    // FIPS 180-2 "abc"
+    const uint8_t expect[32] = {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+                                0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+    uint8_t sha[32];
+    TEST_ASSERT_TRUE(HC15Sha256::compute(reinterpret_cast<const uint8_t *>("abc"), 3, sha));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expect, sha, 32);
+}
+
+void test_header_parse(void)
+{
+    HC15DeltaHeader header;
+    TEST_ASSERT_TRUE(header.parse(patch_));
+    TEST_ASSERT_EQUAL_UINT32(OLD_SIZE, header.base_size);
+    TEST_ASSERT_EQUAL_UINT32(NEW_SIZE, header.target_size);
+    patch_[0] = 'X';
+    TEST_ASSERT_FALSE(header.parse(patch_));
+}
+
+void test_apply_in_one_piece(void)
+{
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(HC15_OTA_RESULT::OK), static_cast<int>(apply(patch_len_)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expect_, out_, NEW_SIZE);
+}
+
+void test_apply_byte_by_byte(void)
+{
+    // 每个字节单独 feed，覆盖所有状态在边界处的续接
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(HC15_OTA_RESULT::OK), static_cast<int>(apply(1)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expect_, out_, NEW_SIZE);
+}
+
+void test_wrong_target_hash(void)
+{
+    patch_[44] ^= 1;
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(HC15_OTA_RESULT::HASH_MISMATCH), static_cast<int>(apply(7)));
+}
+
+void test_truncated_patch(void)
+{
+    patch_len_ -= 3;
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(HC15_OTA_RESULT::BAD_PATCH), static_cast<int>(apply(patch_len_)));
+}
+
+void test_rejects_varint_overflow(void)
+{
+    patch_len_ = HC15_DELTA_HEADER_LEN;
+    put8(static_cast<uint8_t>(HC15_DELTA_OP::COPY));
+    for (int i = 0; i < 4; i++)
+        put8(0xFF);
+    put8(0x1F); // 第 5 个字节超出 32 位
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(HC15_OTA_RESULT::BAD_PATCH), static_cast<int>(apply(patch_len_)));
+}
+
+void test_rejects_seek_outside_base(void)
+{
+    patch_len_ = HC15_DELTA_HEADER_LEN;
+    putOp(HC15_DELTA_OP::SEEK, (OLD_SIZE + 1) << 1);
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(HC15_OTA_RESULT::BAD_PATCH), static_cast<int>(apply(patch_len_)));
+}
+
+void test_rejects_unknown_op(void)
+{
+    patch_len_ = HC15_DELTA_HEADER_LEN;
+    put8(4);
+    TEST_ASSERT_EQUAL_INT(static_cast<int>(HC15_OTA_RESULT::BAD_PATCH), static_cast<int>(apply(patch_len_)));
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sha256_known_answer);
+    RUN_TEST(test_header_parse);
+    RUN_TEST(test_apply_in_one_piece);
+    RUN_TEST(test_apply_byte_by_byte);
+    RUN_TEST(test_wrong_target_hash);
+    RUN_TEST(test_truncated_patch);
+    RUN_TEST(test_rejects_varint_overflow);
+    RUN_TEST(test_rejects_seek_outside_base);
+    RUN_TEST(test_rejects_unknown_op);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup()
+{
+    delay(2000); // 等串口监视器连上
+    runUnityTests();
+}
+
+void loop() {}
+#else
+int main(void)
+{
+    return runUnityTests();
+}
+#endif
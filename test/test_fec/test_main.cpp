@@ -0,0 +1,113 @@
+#include <unity.h>
+#include <lora_fec.hpp>
+
+static uint8_t block_[255];
+static uint8_t clean_[255];
+
+/*
+ * @brief Deterministic data + parity block of n bytes, kept in clean_ for comparison.
+ */
+static void makeBlock(size_t n, uint8_t npar, uint32_t seed)
+{
+    size_t k = n - npar;
+    for (size_t i = 0; i < k; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        block_[i] = static_cast<uint8_t>(seed >> 16);
+    }
+    HC15ReedSolomon::encode(block_, k, block_ + k, npar);
+    memcpy(clean_, block_, n);
+}
+
+/*
+ * @brief Flip count bytes at distinct positions spread over the block (data and parity).
+ */
+static void corrupt(size_t n, int count, uint8_t pattern)
+{
+    for (int e = 0; e < count; e++)
+        block_[(e * 37 + 5) % n] ^= static_cast<uint8_t>(pattern + e * 17) | 1;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_clean_block_decodes_unchanged(void)
+{
+    makeBlock(64, 16, 1);
+    TEST_ASSERT_EQUAL_INT(0, HC15ReedSolomon::decode(block_, 64, 16));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(clean_, block_, 64);
+}
+
+void test_corrects_up_to_half_npar(void)
+{
+    const uint8_t modes[] = {8, 16, 32};
+    for (uint8_t npar : modes)
+    {
+        for (int errors = 1; errors <= npar / 2; errors++)
+        {
+            makeBlock(120, npar, errors * 7 + npar);
+            corrupt(120, errors, 0x5A);
+            TEST_ASSERT_EQUAL_INT(errors, HC15ReedSolomon::decode(block_, 120, npar));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(clean_, block_, 120);
+        }
+    }
+}
+
+void test_full_length_block(void)
+{
+    makeBlock(255, 32, 99);
+    corrupt(255, 16, 0xC3);
+    TEST_ASSERT_EQUAL_INT(16, HC15ReedSolomon::decode(block_, 255, 32));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(clean_, block_, 255);
+}
+
+void test_beyond_capacity_is_not_miscorrected(void)
+{
+    // npar / 2 + 1 个错误超出纠错能力：要么报告失败，要么结果必然不等于原块，不能说纠正成功
+    const uint8_t modes[] = {8, 16, 32};
+    for (uint8_t npar : modes)
+    {
+        makeBlock(100, npar, npar);
+        corrupt(100, npar / 2 + 1, 0x21);
+        int r = HC15ReedSolomon::decode(block_, 100, npar);
+        if (r >= 0)
+            TEST_ASSERT_TRUE(memcmp(clean_, block_, 100) != 0);
+    }
+}
+
+void test_rejects_bad_arguments(void)
+{
+    makeBlock(40, 8, 3);
+    TEST_ASSERT_EQUAL_INT(-1, HC15ReedSolomon::decode(block_, 40, 0));
+    TEST_ASSERT_EQUAL_INT(-1, HC15ReedSolomon::decode(block_, 8, 8));
+    TEST_ASSERT_EQUAL_INT(-1, HC15ReedSolomon::decode(block_, 40, HC15_RS_MAX_PARITY + 1));
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_block_decodes_unchanged);
+    RUN_TEST(test_corrects_up_to_half_npar);
+    RUN_TEST(test_full_length_block);
+    RUN_TEST(test_beyond_capacity_is_not_miscorrected);
+    RUN_TEST(test_rejects_bad_arguments);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup()
+{
+    delay(2000); // 等串口监视器连上
+    runUnityTests();
+}
+
+void loop() {}
+#else
+int main(void)
+{
+    return runUnityTests();
+}
+#endif
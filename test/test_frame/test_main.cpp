@@ -0,0 +1,154 @@
+#include <unity.h>
+#include <lora_frame.hpp>
+
+static HC15Frame makeFrame(uint8_t len)
+{
+    HC15Frame f;
+    memset(&f, 0, sizeof(f));
+    f.flags = HC15_FLAG_RELAY;
+    f.type = 3;
+    f.dst = 0x1234;
+    f.src = 0xBEEF;
+    f.seq = 0x0102;
+    f.port = 7;
+    f.len = len;
+    for (uint8_t i = 0; i < len; i++)
+        f.payload[i] = static_cast<uint8_t>(i * 3 + 1);
+    return f;
+}
+
+static void assertSameFrame(const HC15Frame &a, const HC15Frame &b)
+{
+    TEST_ASSERT_EQUAL_HEX8(a.flags, b.flags);
+    TEST_ASSERT_EQUAL_UINT8(a.type, b.type);
+    TEST_ASSERT_EQUAL_HEX16(a.dst, b.dst);
+    TEST_ASSERT_EQUAL_HEX16(a.src, b.src);
+    TEST_ASSERT_EQUAL_UINT16(a.seq, b.seq);
+    TEST_ASSERT_EQUAL_UINT8(a.port, b.port);
+    TEST_ASSERT_EQUAL_UINT8(a.len, b.len);
+    if (a.len)
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(a.payload, b.payload, a.len);
+}
+
+/*
+ * @brief Feed the wire bytes one at a time.
+ * @return The number of frames the parser completed.
+ */
+static int feedAll(HC15FrameParser &parser, const uint8_t *wire, size_t len)
+{
+    int frames = 0;
+    for (size_t i = 0; i < len; i++)
+        frames += parser.feed(wire[i]) ? 1 : 0;
+    return frames;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_round_trip(void)
+{
+    const uint8_t lens[] = {0, 1, 20, HC15_FRAME_MAX_PAYLOAD};
+    for (uint8_t len : lens)
+    {
+        HC15Frame f = makeFrame(len);
+        uint8_t wire[HC15_FRAME_MAX_WIRE];
+        size_t n = HC15FrameCodec::encode(f, wire, sizeof(wire));
+        TEST_ASSERT_EQUAL_UINT32(HC15_FRAME_OVERHEAD + len, n);
+
+        HC15FrameParser parser;
+        TEST_ASSERT_EQUAL_INT(1, feedAll(parser, wire, n));
+        assertSameFrame(f, parser.frame());
+    }
+}
+
+void test_encode_rejects_small_buffer(void)
+{
+    HC15Frame f = makeFrame(20);
+    uint8_t wire[HC15_FRAME_OVERHEAD + 19];
+    TEST_ASSERT_EQUAL_UINT32(0, HC15FrameCodec::encode(f, wire, sizeof(wire)));
+}
+
+void test_bad_crc_then_resync(void)
+{
+    HC15Frame a = makeFrame(10);
+    HC15Frame b = makeFrame(30);
+    b.seq = 0x0203;
+    uint8_t wire[2 * HC15_FRAME_MAX_WIRE + 4];
+    size_t n = 0;
+    wire[n++] = 0x00; // 起始噪声
+    wire[n++] = 0x55;
+    size_t first = n;
+    n += HC15FrameCodec::encode(a, wire + n, sizeof(wire) - n);
+    wire[first + 6] ^= 0x40; // 破坏第一帧的 SRC
+    n += HC15FrameCodec::encode(b, wire + n, sizeof(wire) - n);
+
+    HC15FrameParser parser;
+    TEST_ASSERT_EQUAL_INT(1, feedAll(parser, wire, n));
+    assertSameFrame(b, parser.frame());
+    TEST_ASSERT_EQUAL_UINT32(1, parser.badFrames());
+    TEST_ASSERT_TRUE(parser.idle());
+}
+
+void test_fec_corrects_errors(void)
+{
+    const HC15_FEC_MODE modes[] = {HC15_FEC_MODE::LIGHT, HC15_FEC_MODE::MEDIUM, HC15_FEC_MODE::STRONG};
+    for (HC15_FEC_MODE mode : modes)
+    {
+        uint8_t npar = static_cast<uint8_t>(mode);
+        HC15Frame f = makeFrame(40);
+        uint8_t wire[HC15_FRAME_MAX_WIRE];
+        size_t n = HC15FrameCodec::encodeFec(f, mode, wire, sizeof(wire));
+        TEST_ASSERT_TRUE(n > 0);
+
+        // 头部之后（LEN + 帧体 + CRC + 校验）打 npar / 2 个错
+        for (int e = 0; e < npar / 2; e++)
+            wire[HC15_FRAME_FEC_HEADER_LEN + (e * 11) % (n - HC15_FRAME_FEC_HEADER_LEN)] ^= 0xA5;
+
+        HC15FrameParser parser;
+        TEST_ASSERT_EQUAL_INT(1, feedAll(parser, wire, n));
+        assertSameFrame(f, parser.frame());
+        TEST_ASSERT_EQUAL_UINT32(npar / 2, parser.fecCorrected()); // 按字节计
+        TEST_ASSERT_EQUAL_UINT32(0, parser.fecFailed());
+    }
+}
+
+void test_fec_length_vote_survives_one_error(void)
+{
+    HC15Frame f = makeFrame(12);
+    uint8_t wire[HC15_FRAME_MAX_WIRE];
+    size_t n = HC15FrameCodec::encodeFec(f, HC15_FEC_MODE::LIGHT, wire, sizeof(wire));
+    wire[2] ^= 0xFF; // 三份 LEN 中坏一份
+
+    HC15FrameParser parser;
+    TEST_ASSERT_EQUAL_INT(1, feedAll(parser, wire, n));
+    assertSameFrame(f, parser.frame());
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_encode_rejects_small_buffer);
+    RUN_TEST(test_bad_crc_then_resync);
+    RUN_TEST(test_fec_corrects_errors);
+    RUN_TEST(test_fec_length_vote_survives_one_error);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup()
+{
+    delay(2000); // 等串口监视器连上
+    runUnityTests();
+}
+
+void loop() {}
+#else
+int main(void)
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,187 @@
+#include <unity.h>
+#include <lora_host.hpp>
+
+static uint8_t stream_[6 * HC15_HOST_MAX_RECORD];
+static size_t stream_len_ = 0;
+static uint16_t seqs_[8];
+static uint64_t stamps_[8];
+static int frames_ = 0;
+
+static void onFrame(uint64_t ts_us, const HC15Frame &frame, void *)
+{
+    if (frames_ < 8)
+    {
+        seqs_[frames_] = frame.seq;
+        stamps_[frames_] = ts_us;
+    }
+    frames_++;
+}
+
+/*
+ * @brief Append one FRAME record.
+ * @return Its offset in stream_.
+ */
+static size_t appendFrame(uint16_t seq, uint8_t len)
+{
+    HC15Frame f;
+    memset(&f, 0, sizeof(f));
+    f.type = 1;
+    f.dst = 0x0001;
+    f.src = 0x0042;
+    f.seq = seq;
+    f.len = len;
+    for (uint8_t i = 0; i < len; i++)
+        f.payload[i] = static_cast<uint8_t>(seq + i);
+    size_t at = stream_len_;
+    stream_len_ += HC15HostCodec::encodeFrame(1000000ull * seq, f, stream_ + at, sizeof(stream_) - at);
+    return at;
+}
+
+static void appendGarbage(const uint8_t *bytes, size_t len)
+{
+    memcpy(stream_ + stream_len_, bytes, len);
+    stream_len_ += len;
+}
+
+/*
+ * @brief Decode stream_ fed in pieces of step bytes.
+ */
+static size_t decode(HC15HostDecoder &decoder, size_t step)
+{
+    size_t records = 0;
+    for (size_t i = 0; i < stream_len_; i += step)
+        records += decoder.feed(stream_ + i, stream_len_ - i < step ? stream_len_ - i : step);
+    return records;
+}
+
+void setUp(void)
+{
+    stream_len_ = 0;
+    frames_ = 0;
+}
+
+void tearDown(void) {}
+
+void test_round_trip(void)
+{
+    appendFrame(1, 0);
+    appendFrame(2, HC15_FRAME_MAX_BODY);
+
+    HC15HostDecoder decoder;
+    decoder.setFrameCallback(onFrame);
+    TEST_ASSERT_EQUAL_UINT32(2, decode(decoder, stream_len_));
+    TEST_ASSERT_EQUAL_INT(2, frames_);
+    TEST_ASSERT_EQUAL_UINT16(1, seqs_[0]);
+    TEST_ASSERT_EQUAL_UINT16(2, seqs_[1]);
+    TEST_ASSERT_TRUE(stamps_[1] == 2000000ull);
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.badRecords());
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.skippedBytes());
+}
+
+void test_joins_mid_stream(void)
+{
+    const uint8_t noise[] = {0x00, 0x13, 0x37, 0xFF};
+    appendGarbage(noise, sizeof(noise));
+    appendFrame(7, 10);
+
+    HC15HostDecoder decoder;
+    decoder.setFrameCallback(onFrame);
+    TEST_ASSERT_EQUAL_UINT32(1, decode(decoder, 3));
+    TEST_ASSERT_EQUAL_UINT16(7, seqs_[0]);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(noise), decoder.skippedBytes());
+}
+
+void test_resync_after_bad_crc(void)
+{
+    appendFrame(1, 12);
+    size_t bad = appendFrame(2, 12);
+    appendFrame(3, 12);
+    stream_[bad + 8] ^= 0x01; // 第二条记录体内翻一位
+
+    for (size_t step = 1; step <= stream_len_; step = step * 2 + 1)
+    {
+        frames_ = 0;
+        HC15HostDecoder decoder;
+        decoder.setFrameCallback(onFrame);
+        TEST_ASSERT_EQUAL_UINT32(2, decode(decoder, step));
+        TEST_ASSERT_EQUAL_INT(2, frames_);
+        TEST_ASSERT_EQUAL_UINT16(1, seqs_[0]);
+        TEST_ASSERT_EQUAL_UINT16(3, seqs_[1]);
+        TEST_ASSERT_EQUAL_UINT32(1, decoder.badRecords());
+    }
+}
+
+void test_resync_inside_swallowed_record(void)
+{
+    // 坏记录的 LEN 变大，吞进了下一条记录的开头：下一条的 SYNC 已在缓冲里，不能丢
+    size_t bad = appendFrame(1, 4);
+    appendFrame(2, 4);
+    appendFrame(3, 4);
+    stream_[bad + 2] += 20;
+
+    HC15HostDecoder decoder;
+    decoder.setFrameCallback(onFrame);
+    TEST_ASSERT_EQUAL_UINT32(2, decode(decoder, 1));
+    TEST_ASSERT_EQUAL_INT(2, frames_);
+    TEST_ASSERT_EQUAL_UINT16(2, seqs_[0]);
+    TEST_ASSERT_EQUAL_UINT16(3, seqs_[1]);
+    TEST_ASSERT_TRUE(decoder.badRecords() >= 1);
+}
+
+void test_stats_record(void)
+{
+    HC15HostStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.received = 100;
+    stats.fec_failed = 3;
+    stream_len_ = HC15HostCodec::encodeStats(42, 0x0007, stats, stream_, sizeof(stream_));
+    TEST_ASSERT_TRUE(stream_len_ > 0);
+
+    struct Seen
+    {
+        uint16_t gateway;
+        HC15HostStats stats;
+    } seen;
+    memset(&seen, 0, sizeof(seen));
+    HC15HostDecoder decoder;
+    decoder.setStatsCallback(
+        [](uint64_t, uint16_t gateway, const HC15HostStats &s, void *ctx)
+        {
+            Seen *out = static_cast<Seen *>(ctx);
+            out->gateway = gateway;
+            out->stats = s;
+        },
+        &seen);
+    TEST_ASSERT_EQUAL_UINT32(1, decode(decoder, stream_len_));
+    TEST_ASSERT_EQUAL_HEX16(0x0007, seen.gateway);
+    TEST_ASSERT_EQUAL_UINT32(100, seen.stats.received);
+    TEST_ASSERT_EQUAL_UINT32(3, seen.stats.fec_failed);
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_joins_mid_stream);
+    RUN_TEST(test_resync_after_bad_crc);
+    RUN_TEST(test_resync_inside_swallowed_record);
+    RUN_TEST(test_stats_record);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup()
+{
+    delay(2000); // 等串口监视器连上
+    runUnityTests();
+}
+
+void loop() {}
+#else
+int main(void)
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,111 @@
+#include <unity.h>
+#include <math.h>
+#include <lora_schema.hpp>
+
+typedef HC15Field<11, -400, 1250, 10> Temp;  // -40.0 ~ 125.0 ℃，0.1 ℃
+typedef HC15Field<8, 0, 200, 1, 2> Battery; // 0 ~ 400，步长 2
+typedef HC15Schema<Temp, HC15UintField<3>, HC15FlagField, Battery> Report;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_size_is_sum_of_fields(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(11 + 3 + 1 + 8, Report::BITS);
+    TEST_ASSERT_EQUAL_UINT16(3, Report::BYTES);
+}
+
+void test_round_trip(void)
+{
+    uint8_t buf[Report::BYTES];
+    TEST_ASSERT_EQUAL_UINT32(Report::BYTES, Report::encode(buf, 23.4f, 5, true, 314.0f));
+
+    float t, b;
+    uint32_t n;
+    bool f;
+    TEST_ASSERT_TRUE(Report::decode(buf, sizeof(buf), t, n, f, b));
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 23.4f, t);
+    TEST_ASSERT_EQUAL_UINT32(5, n);
+    TEST_ASSERT_TRUE(f);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 314.0f, b);
+}
+
+void test_bit_layout_is_msb_first(void)
+{
+    // Temp 原始值 = (0 - -400) = 400 = 0b00110010000，接着 3 位 7、1 位 0、8 位 0
+    uint8_t buf[Report::BYTES];
+    Report::encode(buf, 0.0f, 7, false, 0.0f);
+    TEST_ASSERT_EQUAL_HEX8(0x32, buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x1C, buf[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, buf[2]);
+}
+
+void test_clamps_and_saturates(void)
+{
+    uint8_t buf[Report::BYTES];
+    Report::encode(buf, 300.0f, 100, false, -5.0f);
+
+    float t, b;
+    uint32_t n;
+    bool f;
+    TEST_ASSERT_TRUE(Report::decode(buf, sizeof(buf), t, n, f, b));
+    TEST_ASSERT_EQUAL_FLOAT(125.0f, t);
+    TEST_ASSERT_EQUAL_UINT32(7, n);
+    TEST_ASSERT_FALSE(f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, b);
+}
+
+void test_nan_packs_as_min(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, Temp::pack(NAN));
+    TEST_ASSERT_EQUAL_UINT32(0, Battery::pack(NAN));
+    TEST_ASSERT_EQUAL_FLOAT(-40.0f, Temp::unpack(Temp::pack(NAN)));
+}
+
+void test_fractional_scale_rounds(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(100, Battery::pack(200.0f));
+    TEST_ASSERT_EQUAL_UINT32(101, Battery::pack(201.0f)); // 100.5 四舍五入
+    TEST_ASSERT_EQUAL_UINT32(200, Battery::pack(1000.0f));
+    TEST_ASSERT_EQUAL_FLOAT(202.0f, Battery::unpack(101));
+}
+
+void test_decode_rejects_short_input(void)
+{
+    uint8_t buf[Report::BYTES] = {0};
+    float t, b;
+    uint32_t n;
+    bool f;
+    TEST_ASSERT_FALSE(Report::decode(buf, Report::BYTES - 1, t, n, f, b));
+}
+
+int runUnityTests(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_size_is_sum_of_fields);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_bit_layout_is_msb_first);
+    RUN_TEST(test_clamps_and_saturates);
+    RUN_TEST(test_nan_packs_as_min);
+    RUN_TEST(test_fractional_scale_rounds);
+    RUN_TEST(test_decode_rejects_short_input);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup()
+{
+    delay(2000); // 等串口监视器连上
+    runUnityTests();
+}
+
+void loop() {}
+#else
+int main(void)
+{
+    return runUnityTests();
+}
+#endif
@@ -0,0 +1,285 @@
+/*
+ * Patch generator for the delta firmware update (HC15OtaReceiver, lora_ota.hpp).
+ *
+ *   g++ -O2 -std=c++11 -I lib/lora tools/hc15_delta.cpp -o hc15_delta
+ *   ./hc15_delta old.bin new.bin patch.hcdp
+ *
+ * old.bin must be the image the nodes are running, the node checks its hash before applying.
+ * Matching follows bsdiff: a suffix array over the old image finds long approximate matches, which
+ * become ADD ops (zero-run coded diffs); the bytes between matches become INSERT, cursor jumps SEEK.
+ * The patch is then sent as a transfer with an id in the OTA range (HC15_OTA_XFER_ID_FIRST ..).
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include <lora_delta.hpp>
+
+typedef std::vector<uint8_t> Bytes;
+
+/*
+ * Suffix array of the old image by prefix doubling, sa[0] is the empty suffix.
+ */
+static std::vector<int32_t> suffixArray(const Bytes &old)
+{
+    int32_t n = static_cast<int32_t>(old.size());
+    std::vector<int32_t> sa(n + 1), rank(n + 1), tmp(n + 1);
+    for (int32_t i = 0; i <= n; i++)
+    {
+        sa[i] = i;
+        rank[i] = i < n ? old[i] : -1;
+    }
+    for (int32_t k = 1;; k <<= 1)
+    {
+        auto key = [&](int32_t i) { return i + k <= n ? rank[i + k] : -1; };
+        auto less = [&](int32_t a, int32_t b) { return rank[a] != rank[b] ? rank[a] < rank[b] : key(a) < key(b); };
+        std::sort(sa.begin(), sa.end(), less);
+        tmp[sa[0]] = 0;
+        for (int32_t i = 1; i <= n; i++)
+            tmp[sa[i]] = tmp[sa[i - 1]] + (less(sa[i - 1], sa[i]) ? 1 : 0);
+        rank.swap(tmp);
+        if (rank[sa[n]] == n)
+            break; // 所有后缀已经区分开
+    }
+    return sa;
+}
+
+static int32_t matchLen(const uint8_t *a, int32_t alen, const uint8_t *b, int32_t blen)
+{
+    int32_t i = 0;
+    while (i < alen && i < blen && a[i] == b[i])
+        i++;
+    return i;
+}
+
+/*
+ * @brief Longest match of nw[0..nlen) in the old image.
+ */
+static int32_t search(const std::vector<int32_t> &sa, const Bytes &old, const uint8_t *nw, int32_t nlen, int32_t &pos)
+{
+    int32_t n = static_cast<int32_t>(old.size());
+    int32_t st = 0, en = n;
+    while (en - st >= 2)
+    {
+        int32_t x = st + (en - st) / 2;
+        int32_t cmp = memcmp(old.data() + sa[x], nw, std::min(n - sa[x], nlen));
+        if (cmp < 0)
+            st = x;
+        else
+            en = x;
+    }
+    int32_t a = matchLen(old.data() + sa[st], n - sa[st], nw, nlen);
+    int32_t b = matchLen(old.data() + sa[en], n - sa[en], nw, nlen);
+    pos = a > b ? sa[st] : sa[en];
+    return a > b ? a : b;
+}
+
+static void putVarint(Bytes &out, uint32_t v)
+{
+    do
+    {
+        uint8_t c = v & 0x7F;
+        v >>= 7;
+        out.push_back(v ? c | 0x80 : c);
+    } while (v);
+}
+
+static void putOp(Bytes &out, HC15_DELTA_OP op, uint32_t v)
+{
+    out.push_back(static_cast<uint8_t>(op));
+    putVarint(out, v);
+}
+
+static void put32(Bytes &out, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+/*
+ * @brief ADD (or COPY when nothing differs) for len bytes at the current cursors.
+ */
+static void putAdd(Bytes &out, const uint8_t *oldp, const uint8_t *nw, int32_t len)
+{
+    if (len <= 0)
+        return;
+    Bytes body;
+    bool changed = false;
+    for (int32_t i = 0; i < len;)
+    {
+        uint8_t d = static_cast<uint8_t>(nw[i] - oldp[i]);
+        if (d)
+        {
+            body.push_back(d);
+            changed = true;
+            i++;
+            continue;
+        }
+        int32_t run = 0;
+        while (i + run < len && nw[i + run] == oldp[i + run])
+            run++;
+        body.push_back(0);
+        putVarint(body, run);
+        i += run;
+    }
+    if (!changed)
+    {
+        putOp(out, HC15_DELTA_OP::COPY, len);
+        return;
+    }
+    putOp(out, HC15_DELTA_OP::ADD, len);
+    out.insert(out.end(), body.begin(), body.end());
+}
+
+static Bytes diff(const Bytes &old, const Bytes &nw)
+{
+    std::vector<int32_t> sa = suffixArray(old);
+    int32_t oldsize = static_cast<int32_t>(old.size());
+    int32_t newsize = static_cast<int32_t>(nw.size());
+    Bytes out;
+
+    // bsdiff 的匹配扫描，输出换成 ADD / INSERT / SEEK
+    int32_t scan = 0, len = 0, pos = 0, lastscan = 0, lastpos = 0, lastoffset = 0;
+    while (scan < newsize)
+    {
+        int32_t oldscore = 0;
+        int32_t scsc;
+        for (scsc = scan += len; scan < newsize; scan++)
+        {
+            len = search(sa, old, nw.data() + scan, newsize - scan, pos);
+            for (; scsc < scan + len; scsc++)
+            {
+                if (scsc + lastoffset < oldsize && old[scsc + lastoffset] == nw[scsc])
+                    oldscore++;
+            }
+            if ((len == oldscore && len != 0) || len > oldscore + 8)
+                break;
+            if (scan + lastoffset < oldsize && old[scan + lastoffset] == nw[scan])
+                oldscore--;
+        }
+        if (len == oldscore && scan != newsize)
+            continue;
+
+        // 向前延伸上一个匹配
+        int32_t s = 0, sf = 0, lenf = 0;
+        for (int32_t i = 0; lastscan + i < scan && lastpos + i < oldsize;)
+        {
+            if (old[lastpos + i] == nw[lastscan + i])
+                s++;
+            i++;
+            if (s * 2 - i > sf * 2 - lenf)
+            {
+                sf = s;
+                lenf = i;
+            }
+        }
+        // 向后延伸新匹配
+        int32_t lenb = 0;
+        if (scan < newsize)
+        {
+            int32_t sb = 0;
+            s = 0;
+            for (int32_t i = 1; scan >= lastscan + i && pos >= i; i++)
+            {
+                if (old[pos - i] == nw[scan - i])
+                    s++;
+                if (s * 2 - i > sb * 2 - lenb)
+                {
+                    sb = s;
+                    lenb = i;
+                }
+            }
+        }
+        if (lastscan + lenf > scan - lenb)
+        {
+            int32_t overlap = (lastscan + lenf) - (scan - lenb);
+            int32_t ss = 0, lens = 0;
+            s = 0;
+            for (int32_t i = 0; i < overlap; i++)
+            {
+                if (nw[lastscan + lenf - overlap + i] == old[lastpos + lenf - overlap + i])
+                    s++;
+                if (nw[scan - lenb + i] == old[pos - lenb + i])
+                    s--;
+                if (s > ss)
+                {
+                    ss = s;
+                    lens = i + 1;
+                }
+            }
+            lenf += lens - overlap;
+            lenb -= lens;
+        }
+
+        putAdd(out, old.data() + lastpos, nw.data() + lastscan, lenf);
+        int32_t extra = (scan - lenb) - (lastscan + lenf);
+        if (extra > 0)
+        {
+            putOp(out, HC15_DELTA_OP::INSERT, extra);
+            out.insert(out.end(), nw.begin() + lastscan + lenf, nw.begin() + scan - lenb);
+        }
+        int32_t seek = (pos - lenb) - (lastpos + lenf);
+        if (seek && scan < newsize)
+            putOp(out, HC15_DELTA_OP::SEEK, (static_cast<uint32_t>(seek) << 1) ^ static_cast<uint32_t>(seek >> 31)); // zigzag
+
+        lastscan = scan - lenb;
+        lastpos = pos - lenb;
+        lastoffset = pos - scan;
+    }
+    return out;
+}
+
+static bool readFile(const char *path, Bytes &out)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        perror(path);
+        return false;
+    }
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        out.insert(out.end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 4)
+    {
+        fprintf(stderr, "usage: %s <old.bin> <new.bin> <patch>\n", argv[0]);
+        return 1;
+    }
+    Bytes old, nw;
+    if (!readFile(argv[1], old) || !readFile(argv[2], nw))
+        return 1;
+    if (nw.empty() || old.size() > 0x7FFFFFFF || nw.size() > 0x7FFFFFFF)
+    {
+        fprintf(stderr, "image size not supported\n");
+        return 1;
+    }
+
+    Bytes patch(HC15_DELTA_MAGIC, HC15_DELTA_MAGIC + 4);
+    uint8_t sha[32];
+    put32(patch, static_cast<uint32_t>(old.size()));
+    HC15Sha256::compute(old.data(), old.size(), sha);
+    patch.insert(patch.end(), sha, sha + 32);
+    put32(patch, static_cast<uint32_t>(nw.size()));
+    HC15Sha256::compute(nw.data(), nw.size(), sha);
+    patch.insert(patch.end(), sha, sha + 32);
+    Bytes body = diff(old, nw);
+    patch.insert(patch.end(), body.begin(), body.end());
+
+    FILE *f = fopen(argv[3], "wb");
+    if (!f || fwrite(patch.data(), 1, patch.size(), f) != patch.size())
+    {
+        perror(argv[3]);
+        return 1;
+    }
+    fclose(f);
+    printf("%s: %zu bytes for a %zu byte image (%.1f%%)\n", argv[3], patch.size(), nw.size(), 100.0 * patch.size() / nw.size());
+    return 0;
+}
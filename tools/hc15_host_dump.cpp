@@ -0,0 +1,113 @@
+/*
+ * Reference host decoder for the gateway's binary upstream (lora_host.hpp).
+ *
+ *   g++ -O2 -std=c++11 -I lib/lora tools/hc15_host_dump.cpp -o hc15_host_dump
+ *   stty -F /dev/ttyACM0 raw && ./hc15_host_dump /dev/ttyACM0 [/dev/ttyACM1 ...]
+ *
+ * Reads every gateway port with poll(), one line per frame plus per-node counters on each STATS record.
+ */
+#include <lora_host.hpp>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define DUMP_MAX_PORTS 16
+#define DUMP_MAX_NODES 256
+
+struct NodeCount
+{
+    uint16_t id;
+    uint32_t frames;
+    uint64_t last_us;
+};
+
+struct Gateway
+{
+    const char *path;
+    HC15HostDecoder decoder;
+    NodeCount nodes[DUMP_MAX_NODES];
+    size_t node_count;
+};
+
+static NodeCount *findNode(Gateway *gw, uint16_t id)
+{
+    for (size_t i = 0; i < gw->node_count; i++)
+    {
+        if (gw->nodes[i].id == id)
+            return &gw->nodes[i];
+    }
+    if (gw->node_count == DUMP_MAX_NODES)
+        return nullptr;
+    NodeCount *n = &gw->nodes[gw->node_count++];
+    n->id = id;
+    n->frames = 0;
+    n->last_us = 0;
+    return n;
+}
+
+static void onFrame(uint64_t ts_us, const HC15Frame &frame, void *ctx)
+{
+    Gateway *gw = static_cast<Gateway *>(ctx);
+    NodeCount *n = findNode(gw, frame.src);
+    if (n)
+    {
+        n->frames++;
+        n->last_us = ts_us;
+    }
+    printf("%s %llu node=%u seq=%u type=%u port=%u len=%u\n", gw->path, static_cast<unsigned long long>(ts_us), frame.src,
+           frame.seq, frame.type, frame.port, frame.len);
+}
+
+static void onStats(uint64_t ts_us, uint16_t gateway, const HC15HostStats &s, void *ctx)
+{
+    Gateway *gw = static_cast<Gateway *>(ctx);
+    printf("%s %llu gateway=%u rx=%u drop=%u bad=%u dup=%u rej=%u fec=%u/%u\n", gw->path,
+           static_cast<unsigned long long>(ts_us), gateway, s.received, s.dropped, s.bad, s.duplicates, s.rejected,
+           s.fec_corrected, s.fec_failed);
+    for (size_t i = 0; i < gw->node_count; i++)
+        printf("  node %u: %u frames\n", gw->nodes[i].id, gw->nodes[i].frames);
+}
+
+int main(int argc, char **argv)
+{
+    static Gateway gateways[DUMP_MAX_PORTS];
+    struct pollfd fds[DUMP_MAX_PORTS];
+    int count = 0;
+    for (int i = 1; i < argc && count < DUMP_MAX_PORTS; i++)
+    {
+        int fd = open(argv[i], O_RDONLY | O_NOCTTY);
+        if (fd < 0)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        Gateway *gw = &gateways[count];
+        gw->path = argv[i];
+        gw->decoder.setFrameCallback(onFrame, gw);
+        gw->decoder.setStatsCallback(onStats, gw);
+        fds[count].fd = fd;
+        fds[count].events = POLLIN;
+        count++;
+    }
+    if (count == 0)
+    {
+        fprintf(stderr, "usage: %s <port> [<port> ...]\n", argv[0]);
+        return 1;
+    }
+
+    uint8_t buf[4096];
+    while (poll(fds, count, -1) > 0)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (!(fds[i].revents & (POLLIN | POLLHUP)))
+                continue;
+            ssize_t n = read(fds[i].fd, buf, sizeof(buf));
+            if (n <= 0)
+                return 0;
+            gateways[i].decoder.feed(buf, static_cast<size_t>(n));
+        }
+    }
+    return 0;
+}